@@ -0,0 +1,495 @@
+// -*- mode: c++; -*-
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/aho-corasick.hpp>
+#include <reta/jit.hpp>
+#include <reta/table.hpp>
+
+//
+// A read-only view of an input: files are mapped, the standard input, which
+// may be a pipe, is read into memory.
+//
+struct input_t {
+    explicit input_t (const string& name)
+        : name (name), data (), size (), map_ () {
+        if (name == "-") {
+            buf_.assign (istreambuf_iterator< char > (cin), { });
+            data = buf_.data ();
+            size = buf_.size ();
+            return;
+        }
+
+        const int fd = ::open (name.c_str (), O_RDONLY);
+
+        if (fd < 0)
+            throw runtime_error (name + ": " + strerror (errno));
+
+        struct stat st;
+
+        if (::fstat (fd, &st) < 0) {
+            ::close (fd);
+            throw runtime_error (name + ": " + strerror (errno));
+        }
+
+        size = size_t (st.st_size);
+
+        if (size) {
+            map_ = ::mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (MAP_FAILED == map_) {
+                map_ = 0;
+                ::close (fd);
+                throw runtime_error (name + ": " + strerror (errno));
+            }
+
+            ::madvise (map_, size, MADV_SEQUENTIAL);
+            data = static_cast< const char* > (map_);
+        }
+
+        ::close (fd);
+    }
+
+    ~input_t () {
+        if (map_)
+            ::munmap (map_, size);
+    }
+
+    input_t (const input_t&) = delete;
+    input_t& operator= (const input_t&) = delete;
+
+    string name;
+
+    const char* data;
+    size_t size;
+
+private:
+    void* map_;
+    string buf_;
+};
+
+//
+// A run of whole lines of one input; the output of a work item is kept apart
+// and written in input order once all are done:
+//
+struct work_t {
+    size_t input;
+    const char *first, *last;
+
+    string output;
+    size_t count;
+};
+
+enum struct output_t { lines, count, files };
+
+struct options_t {
+    output_t mode = output_t::lines;
+
+    size_t threads = 0;
+    size_t chunk = size_t (1) << 20;
+
+    bool line = false, prefix = false, stats = false;
+};
+
+static string
+read_patterns (const string& filename) {
+    ifstream in (filename);
+
+    if (!in)
+        throw runtime_error (filename + ": " + strerror (errno));
+
+    string r, s;
+
+    for (; getline (in, s);) {
+        if (s.empty ())
+            continue;
+
+        if (!r.empty ())
+            r += '|';
+
+        r += '(';
+        r += s;
+        r += ')';
+    }
+
+    return r;
+}
+
+//
+// Sets of literals are matched by their Aho-Corasick automaton, built directly
+// from the literals, other patterns by a minimal DFA: searched for in the
+// lines by a search DFA, or matching whole lines by the compiled anchored DFA.
+//
+struct matcher_t {
+    unique_ptr< aho_corasick_t > ac;
+    unique_ptr< search_table_t > table;
+    unique_ptr< jit_t > jit;
+
+    bool line;
+    size_t states;
+};
+
+static inline bool
+match (const matcher_t& m, const char* first, const char* last) {
+    if (m.ac)
+        return m.line
+            ? match (*m.ac, first, last) : search (*m.ac, first, last);
+
+    return m.jit ? match (*m.jit, first, last) : search (*m.table, first, last);
+}
+
+static ostream&
+operator<< (ostream& s, const matcher_t& m) {
+    s << m.states;
+
+    if (m.ac)
+        return s << " (aho-corasick)";
+
+    if (m.table)
+        return s << " (search)";
+
+    return s << (m.jit->native () ? " (native)" : " (table)");
+}
+
+static matcher_t
+compile (const string& r, size_t max_states, bool line) {
+    matcher_t m;
+    m.line = line;
+
+    const auto s = postfix (r);
+
+    vector< string > literals;
+
+    if (literals_of (s, literals)) {
+        m.ac.reset (new aho_corasick_t (literals));
+        m.states = m.ac->states ();
+
+        return m;
+    }
+
+    dfa_options_t options;
+    options.max_states = max_states;
+
+    //
+    // A line matches as soon as a match ends in it:
+    //
+    options.unanchored = options.earliest = !line;
+
+    dfa_t dfa;
+
+    const auto status = make_dfa (make_nfa (simplify (s)), options, dfa);
+
+    if (dfa_status_t::ok != status) {
+        ostringstream ss;
+        ss << "pattern too large for a DFA (" << status << ")";
+        throw runtime_error (ss.str ());
+    }
+
+    dfa = minimize_dfa (dfa);
+
+    if (line)
+        m.jit.reset (new jit_t (dfa));
+    else
+        m.table.reset (new search_table_t (dfa));
+
+    m.states = dfa.states.size ();
+
+    return m;
+}
+
+//
+// Splits every input into chunks of about the given size, moved forward to the
+// next line boundary:
+//
+static vector< work_t >
+make_work (const vector< unique_ptr< input_t > >& inputs, size_t chunk) {
+    vector< work_t > work;
+
+    for (size_t i = 0; i < inputs.size (); ++i) {
+        const char* first = inputs [i]->data;
+        const char* const last = first + inputs [i]->size;
+
+        for (; first != last;) {
+            const char* p = first + (min) (chunk, size_t (last - first));
+
+            if (p != last) {
+                p = static_cast< const char* > (memchr (p, '\n', last - p));
+                p = p ? p + 1 : last;
+            }
+
+            work.push_back (work_t { i, first, p, { }, 0 });
+            first = p;
+        }
+    }
+
+    return work;
+}
+
+static void
+scan (const matcher_t& matcher, const options_t& options, const string& name,
+      atomic< bool >& done, work_t& w) {
+    for (const char* first = w.first; first != w.last;) {
+        if (output_t::files == options.mode && done.load (memory_order_relaxed))
+            return;
+
+        auto p = static_cast< const char* > (
+            memchr (first, '\n', w.last - first));
+
+        const char* const eol = p ? p : w.last;
+
+        if (match (matcher, first, eol)) {
+            ++w.count;
+
+            if (output_t::lines == options.mode) {
+                if (options.prefix)
+                    w.output.append (name).append (1, ':');
+
+                w.output.append (first, eol).append (1, '\n');
+            }
+            else if (output_t::files == options.mode) {
+                done.store (true, memory_order_relaxed);
+                return;
+            }
+        }
+
+        first = p ? p + 1 : w.last;
+    }
+}
+
+static size_t
+run (const matcher_t& matcher, const options_t& options,
+     const vector< unique_ptr< input_t > >& inputs, vector< work_t >& work) {
+    //
+    // Set as soon as a line of the input matches, for the files mode to skip
+    // the rest of its chunks:
+    //
+    unique_ptr< atomic< bool >[] > done (new atomic< bool > [inputs.size ()]);
+
+    for (size_t i = 0; i < inputs.size (); ++i)
+        done [i] = false;
+
+    atomic< size_t > next { 0 };
+
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add (1)) < work.size ();) {
+            auto& w = work [i];
+            scan (matcher, options, inputs [w.input]->name, done [w.input], w);
+        }
+    };
+
+    const size_t n = (min) (
+        options.threads ? options.threads : size_t (
+            (max) (1U, thread::hardware_concurrency ())),
+        (max) (size_t (1), work.size ()));
+
+    vector< thread > pool;
+
+    for (size_t i = 1; i < n; ++i)
+        pool.emplace_back (worker);
+
+    worker ();
+
+    for (auto& t : pool)
+        t.join ();
+
+    return n;
+}
+
+static size_t
+report (const options_t& options,
+        const vector< unique_ptr< input_t > >& inputs,
+        const vector< work_t >& work) {
+    size_t total = 0;
+    auto iter = work.begin ();
+
+    for (size_t i = 0; i < inputs.size (); ++i) {
+        size_t count = 0;
+
+        for (; iter != work.end () && i == iter->input; ++iter) {
+            if (output_t::lines == options.mode)
+                cout.write (iter->output.data (), iter->output.size ());
+
+            count += iter->count;
+        }
+
+        if (output_t::count == options.mode) {
+            if (options.prefix)
+                cout << inputs [i]->name << ':';
+
+            cout << count << '\n';
+        }
+        else if (output_t::files == options.mode && count)
+            cout << inputs [i]->name << '\n';
+
+        total += count;
+    }
+
+    cout.flush ();
+
+    return total;
+}
+
+int main (int argc, char** argv) {
+    using clock_type = chrono::steady_clock;
+
+    options_t options;
+
+    string pattern, pattern_file;
+    vector< string > filenames;
+
+    size_t max_states = 1U << 20;
+
+    po::options_description generic ("Options");
+    generic.add_options ()
+        ("help,h", "this")
+        ("file,f", po::value (&pattern_file),
+         "read patterns from the file, one per line")
+        ("count,c", "print only a count of matching lines per file")
+        ("files-with-matches,l", "print only the names of files with matches")
+        ("line-regexp,x", "match whole lines only")
+        ("threads,j", po::value (&options.threads),
+         "number of threads (default: one per core)")
+        ("chunk-size", po::value (&options.chunk),
+         "bytes of input per work item (default: 1 MiB)")
+        ("max-states", po::value (&max_states),
+         "bound on the number of DFA states")
+        ("stats,s", "report the throughput on the standard error");
+
+    po::options_description hidden;
+    hidden.add_options ()
+        ("args", po::value (&filenames));
+
+    po::options_description all;
+    all.add (generic).add (hidden);
+
+    po::positional_options_description positional;
+    positional.add ("args", -1);
+
+    po::variables_map vm;
+
+    try {
+        po::store (
+            po::command_line_parser (argc, argv)
+            .options (all).positional (positional).run (), vm);
+
+        po::notify (vm);
+    }
+    catch (const exception& e) {
+        cerr << argv [0] << ": " << e.what () << endl;
+        return 2;
+    }
+
+    //
+    // Unless read from a file, the pattern is the first positional argument:
+    //
+    if (pattern_file.empty () && !filenames.empty ()) {
+        pattern = filenames.front ();
+        filenames.erase (filenames.begin ());
+    }
+
+    if (vm.count ("help") || (pattern.empty () && pattern_file.empty ())) {
+        cout << "Usage: " << argv [0]
+             << " [options] PATTERN [FILE]...\n"
+             << "       " << argv [0]
+             << " [options] -f PATTERNS [FILE]...\n\n"
+             << "Prints the lines of the files, or of the standard input, "
+             << "that hold a match\nof the pattern; ^ and $ anchor it at the "
+             << "start and at the end of the line.\n\n"
+             << generic << endl;
+        return vm.count ("help") ? 0 : 2;
+    }
+
+    if (vm.count ("count"))
+        options.mode = output_t::count;
+
+    if (vm.count ("files-with-matches"))
+        options.mode = output_t::files;
+
+    options.line = vm.count ("line-regexp");
+    options.stats = vm.count ("stats");
+    options.chunk = (max) (options.chunk, size_t (1));
+
+    if (filenames.empty ())
+        filenames.emplace_back ("-");
+
+    options.prefix = filenames.size () > 1;
+
+    try {
+        const auto t0 = clock_type::now ();
+
+        if (!pattern_file.empty ())
+            pattern = read_patterns (pattern_file);
+
+        const auto matcher = compile (pattern, max_states, options.line);
+
+        const auto t1 = clock_type::now ();
+
+        vector< unique_ptr< input_t > > inputs;
+
+        for (const auto& s : filenames)
+            inputs.emplace_back (new input_t (s));
+
+        auto work = make_work (inputs, options.chunk);
+
+        const auto t2 = clock_type::now ();
+        const auto threads = run (matcher, options, inputs, work);
+        const auto t3 = clock_type::now ();
+
+        const auto total = report (options, inputs, work);
+
+        if (options.stats) {
+            using seconds_type = chrono::duration< double >;
+
+            size_t bytes = 0;
+
+            for (const auto& p : inputs)
+                bytes += p->size;
+
+            const auto compile_time = seconds_type (t1 - t0).count ();
+            const auto scan_time = seconds_type (t3 - t2).count ();
+
+            cerr << "# states     : " << matcher << "\n"
+                 << "# compile    : " << compile_time * 1e3 << " ms\n"
+                 << "# inputs     : " << inputs.size () << " files, "
+                 << work.size () << " work items, " << threads
+                 << " threads\n"
+                 << "# scanned    : " << bytes << " bytes in "
+                 << scan_time * 1e3 << " ms, "
+                 << (scan_time > 0 ? bytes / scan_time / (1 << 20) : 0)
+                 << " MiB/s\n"
+                 << "# matches    : " << total << endl;
+        }
+
+        return total ? 0 : 1;
+    }
+    catch (const exception& e) {
+        cerr << argv [0] << ": " << e.what () << endl;
+        return 2;
+    }
+}
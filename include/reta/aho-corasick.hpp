@@ -0,0 +1,94 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_AHO_CORASICK_HPP
+#define RETA_AHO_CORASICK_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//
+// Recognizes the postfix form of a finite set of literals, i.e., literals
+// combined only by concatenation and alternation, and collects its strings,
+// sorted and unique; fails on closures, anchors and classes, and on sets
+// larger than the bound:
+//
+bool literals_of (const string&, vector< string >&, size_t = 1U << 16);
+
+//
+// Aho-Corasick automaton of a set of literals, stored as a double-array trie:
+// the children of a state are at the offset of the state plus the byte, in
+// slots that record their owner, and every state keeps its failure link.
+//
+// Small sets of literals also get a Teddy prefilter, used by search () where
+// SSSE3 is available: the first bytes of the literals, spread over 8 buckets,
+// are looked up 16 input positions at a time by shuffles on the nibbles of the
+// input, and only the positions flagged for a bucket are verified.
+//
+struct aho_corasick_t {
+    using size_type = uint32_t;
+
+    static constexpr size_type none = size_type (-1);
+
+    //
+    // Past about two literals a bucket, the nibble masks flag most positions
+    // and the prefilter no longer pays:
+    //
+    static constexpr size_t teddy_max_literals = 16;
+    static constexpr size_t teddy_buckets = 8;
+
+    explicit aho_corasick_t (const vector< string >&, bool prefilter = true);
+
+    size_type next (size_type s, unsigned char c) const {
+        const size_t i = size_t (base [s]) + c;
+        return i < check.size () && check [i] == s ? size_type (i) : none;
+    }
+
+    bool prefilter () const {
+        return fingerprint;
+    }
+
+    size_t states () const {
+        return states_;
+    }
+
+    size_t bytes () const {
+        return
+            (base.size () + check.size () + fail.size ()) * sizeof (size_type) +
+            (terminal.size () + output.size ()) / 8;
+    }
+
+    vector< size_type > base, check, fail;
+
+    //
+    // The states that end a literal, and those whose failure chain reaches
+    // one:
+    //
+    vector< bool > terminal, output;
+
+    size_type start;
+
+    //
+    // Nibble masks of the first fingerprint bytes of the literals, zero when
+    // there is no prefilter:
+    //
+    vector< string > literals;
+    vector< vector< size_t > > buckets;
+
+    vector< uint8_t > lo, hi;
+    size_t fingerprint;
+
+private:
+    size_t states_;
+};
+
+//
+// Anchored, the input is one of the literals; unanchored, one of the literals
+// occurs in the input:
+//
+bool match (const aho_corasick_t&, const char*, const char*);
+bool search (const aho_corasick_t&, const char*, const char*);
+
+#endif // RETA_AHO_CORASICK_HPP
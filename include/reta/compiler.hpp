@@ -0,0 +1,47 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_COMPILER_HPP
+#define RETA_COMPILER_HPP
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Compiles expressions to minimal DFAs, as minimize_dfa_hopcroft (make_dfa
+// (make_nfa (postfix (r)))) does, out of buffers kept from one compilation to
+// the next: the postfix form and its stack, the NFA and its spare states, and
+// the scratch of make_dfa and minimize_dfa_hopcroft, with the DFA in between.
+// Once the buffers have grown to the largest expression, compiling into the
+// same output allocates nothing for expressions of literals; classes still
+// build their ranges and UTF-8 sequences afresh.
+//
+// The automaton is anchored and the construction unbounded, make_dfa with
+// options is there for searches and budgets. One compiler per thread.
+//
+struct compiler_t {
+    //
+    // The states of the output are reused, transitions cleared, as are those
+    // of the automata in between:
+    //
+    void compile (const string&, dfa_t&);
+
+    dfa_t compile (const string&);
+
+private:
+    string postfix_;
+    vector< pair< size_t, size_t > > postfix_stack_;
+
+    nfa_t nfa_;
+    vector< size_t > nfa_stack_;
+    vector< vector< pair< int, size_t > > > spare_;
+
+    dfa_t dfa_;
+    dfa_scratch_t dfa_scratch_;
+    minimize_scratch_t minimize_scratch_;
+};
+
+#endif // RETA_COMPILER_HPP
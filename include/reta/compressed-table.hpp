@@ -0,0 +1,134 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_COMPRESSED_TABLE_HPP
+#define RETA_COMPRESSED_TABLE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+#include <reta/util.hpp>
+
+//
+// Compact transition tables, templated over the type of the state ids, which
+// must hold the states and the dead state (see dead_state ()); they share the
+// matcher below, whose loop is a single table lookup per byte.
+//
+// dense_table_t is the [state][byte] table of table_t with narrowed targets.
+//
+template< typename T >
+struct dense_table_t {
+    using value_type = T;
+
+    static constexpr size_t width = 256;
+
+    explicit dense_table_t (const dfa_t&);
+
+    T next (T s, unsigned char c) const {
+        return targets [size_t (s) * width + c];
+    }
+
+    size_t bytes () const {
+        return targets.size () * sizeof (T) + accept.size () / 8;
+    }
+
+    vector< T > targets;
+    vector< bool > accept;
+    T start, dead;
+};
+
+//
+// Row displacement (Tarjan and Yao): every state keeps a default target, the
+// most frequent one in its row, usually the dead state, and only the other
+// transitions go into a shared vector, at an offset of the state chosen so
+// that the rows interleave like the teeth of combs. The owner of a slot is
+// recorded for the lookup to tell the transitions of the state from those of
+// others.
+//
+template< typename T >
+struct comb_table_t {
+    using value_type = T;
+
+    static constexpr size_t width = 256;
+
+    explicit comb_table_t (const dfa_t&);
+
+    T next (T s, unsigned char c) const {
+        const auto i = base [s] + c;
+        return check [i] == s ? targets [i] : defaults [s];
+    }
+
+    size_t bytes () const {
+        return
+            base.size () * sizeof (uint32_t) +
+            (check.size () + targets.size () + defaults.size ()) * sizeof (T) +
+            accept.size () / 8;
+    }
+
+    vector< uint32_t > base;
+    vector< T > check, targets, defaults;
+    vector< bool > accept;
+    T start, dead;
+};
+
+extern template struct dense_table_t< uint8_t >;
+extern template struct dense_table_t< uint16_t >;
+extern template struct dense_table_t< uint32_t >;
+
+extern template struct comb_table_t< uint8_t >;
+extern template struct comb_table_t< uint16_t >;
+extern template struct comb_table_t< uint32_t >;
+
+namespace detail {
+
+template< typename Table >
+inline bool
+match_compressed (const Table& table, const char* first, const char* last) {
+    auto s = table.start;
+
+    for (; first != last && s != table.dead; ++first)
+        s = table.next (s, (unsigned char)(*first));
+
+    return table.accept [s];
+}
+
+} // namespace detail
+
+template< typename T >
+inline bool
+match (const dense_table_t< T >& table, const char* first, const char* last) {
+    return detail::match_compressed (table, first, last);
+}
+
+template< typename T >
+inline bool
+match (const comb_table_t< T >& table, const char* first, const char* last) {
+    return detail::match_compressed (table, first, last);
+}
+
+//
+// Calls f with the table of the narrowest state type that holds the states of
+// the automaton and its dead state, e.g.:
+//
+//     with_narrowest< comb_table_t > (dfa, [&](const auto& table) {
+//         return match (table, first, last);
+//     });
+//
+template< template< typename > class Table, typename F >
+inline auto
+with_narrowest (const dfa_t& dfa, F f) {
+    const auto n = dead_state (dfa);
+
+    if (n <= (numeric_limits< uint8_t >::max) ())
+        return f (Table< uint8_t > (dfa));
+
+    if (n <= (numeric_limits< uint16_t >::max) ())
+        return f (Table< uint16_t > (dfa));
+
+    return f (Table< uint32_t > (dfa));
+}
+
+#endif // RETA_COMPRESSED_TABLE_HPP
@@ -0,0 +1,123 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_DERIVATIVE_HPP
+#define RETA_DERIVATIVE_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Hash-consed regular expressions, kept in similarity normal form: nested
+// alternations and intersections are flattened, sorted and deduplicated,
+// concatenations are right-nested and the usual identities of the empty set,
+// the empty string and the closure are applied on construction. Structurally
+// equal expressions are the same node.
+//
+// The anchors match the empty string where they hold: ^ at the start of the
+// input, resolved before the first derivative, and $ at its end, so that an
+// expression is nullable where neither holds, and accepting at the end.
+//
+struct expressions_t {
+    using node_type = size_t;
+
+    enum kind_t {
+        empty, epsilon, symbol, concatenation, alternation, intersection,
+        closure, complement, begin_anchor, end_anchor
+    };
+
+    expressions_t ();
+
+    node_type make_empty () const { return empty_; }
+    node_type make_epsilon () const { return epsilon_; }
+
+    node_type make_begin_anchor () const { return begin_; }
+    node_type make_end_anchor () const { return end_; }
+
+    node_type make_symbol (int);
+    node_type make_concatenation (node_type, node_type);
+    node_type make_alternation (node_type, node_type);
+    node_type make_intersection (node_type, node_type);
+    node_type make_closure (node_type);
+    node_type make_complement (node_type);
+
+    //
+    // From the postfix form produced by postfix (), without classes, which
+    // throw invalid_argument:
+    //
+    node_type parse (const string&);
+
+    bool nullable (node_type n) const {
+        return nodes_ [n].nullable;
+    }
+
+    bool accepting (node_type n) const {
+        return nodes_ [n].accepting;
+    }
+
+    //
+    // The expression at the start of the input, with the ^ that hold there
+    // turned into the empty string:
+    //
+    node_type at_begin (node_type);
+
+    node_type derivative (node_type, int);
+
+    //
+    // The DFA of the derivatives of the expression; the derivative which is the
+    // empty set is the implicit dead state:
+    //
+    dfa_t make_dfa (node_type);
+
+    size_t size () const {
+        return nodes_.size ();
+    }
+
+    size_t hits () const {
+        return hits_;
+    }
+
+private:
+    struct node_t {
+        kind_t kind;
+        int symbol;
+        vector< node_type > args;
+        bool nullable, accepting, anchored;
+    };
+
+    struct hash_t {
+        size_t operator() (const node_t&) const;
+    };
+
+    struct equal_t {
+        bool operator() (const node_t&, const node_t&) const;
+    };
+
+    node_type intern (kind_t, int, vector< node_type >);
+
+    node_type make_nary (kind_t, node_type, node_type);
+
+    node_type empty_width (node_type);
+
+    void symbols (node_type, vector< bool >&) const;
+
+private:
+    vector< node_t > nodes_;
+    unordered_map< node_t, node_type, hash_t, equal_t > table_;
+    unordered_map< size_t, node_type > derivatives_;
+
+    node_type empty_, epsilon_, universe_, begin_, end_;
+    size_t hits_;
+};
+
+//
+// Builds the DFA directly from the derivatives of the postfix expression,
+// without going through an NFA, anchors included, classes not:
+//
+dfa_t make_derivative_dfa (const string&);
+
+#endif // RETA_DERIVATIVE_HPP
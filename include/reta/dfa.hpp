@@ -3,25 +3,215 @@
 #ifndef RETA_DFA_HPP
 #define RETA_DFA_HPP
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 using namespace std;
 
 #include <reta/nfa.hpp>
 
-struct dfa_t {
-    using  int_type = int;
-    using size_type = size_t;
+template< typename IntType, typename SizeType >
+struct basic_dfa_t {
+    using  int_type = IntType;
+    using size_type = SizeType;
 
     vector< vector< pair< int_type, size_type > > > states;
     vector< size_type > accept;
     size_type start;
 };
 
+using dfa_t = basic_dfa_t< int, size_t >;
+
+//
+// The DFA with byte labels and the state ids of the type, a quarter of the
+// bytes of dfa_t per transition with 16-bit ids:
+//
+template< typename T >
+using compact_dfa_t = basic_dfa_t< uint8_t, T >;
+
+//
+// Bounds on the subset construction; the memory budget is checked against an
+// estimate of the bytes held by the construction tables.
+//
+// Unanchored, the automaton accepts the inputs with a match ending at their
+// end, starting anywhere, with transitions on all bytes; earliest, it accepts
+// the inputs with a prefix that matches, all such prefixes reaching a single
+// accepting state that loops on all bytes. Together, they make a search:
+// accepting as soon as the input holds a match.
+//
+struct dfa_options_t {
+    using clock_type = chrono::steady_clock;
+
+    size_t max_states = (numeric_limits< size_t >::max) ();
+    size_t max_bytes  = (numeric_limits< size_t >::max) ();
+
+    clock_type::time_point deadline = (clock_type::time_point::max) ();
+
+    bool unanchored = false;
+    bool earliest = false;
+};
+
+enum struct dfa_status_t {
+    ok, state_limit, memory_limit, deadline
+};
+
+ostream& operator<< (ostream&, dfa_status_t);
+
+//
+// Stops as soon as a bound is exceeded, leaving the output empty; callers fall
+// back to simulating the NFA:
+//
+dfa_status_t make_dfa (const nfa_t&, const dfa_options_t&, dfa_t&);
+
+//
+// The buffers of the subset construction, for callers that build one
+// automaton after another: the subsets of the DFA states, sorted, in one
+// arena with an open-addressing table over them, the membership of the NFA
+// states in the set at hand, marked with the current generation, and the
+// spare states of the output. Used by one thread at a time.
+//
+struct dfa_scratch_t {
+    vector< size_t > arena, offsets, table;
+
+    vector< size_t > mark;
+    size_t generation = 0;
+
+    vector< size_t > subset, closure, restart;
+    vector< pair< int, size_t > > moves;
+    vector< size_t > level, next_level;
+
+    vector< vector< pair< int, size_t > > > spare;
+};
+
+//
+// Same, out of the buffers, which keep their storage from one call to the
+// next, as do the states of the output:
+//
+dfa_status_t make_dfa (
+    const nfa_t&, const dfa_options_t&, dfa_t&, dfa_scratch_t&);
+
 dfa_t make_dfa (const nfa_t&);
+
+//
+// Missing transitions lead to the dead state, whose canonical id is the number
+// of states; dense tables append it as their last row:
+//
+template< typename I, typename S >
+inline size_t dead_state (const basic_dfa_t< I, S >& dfa) {
+    return dfa.states.size ();
+}
+
+//
+// Calls f with the compact automaton of the narrowest state type that holds
+// the states and the dead state, once the automaton is built and minimized,
+// e.g.:
+//
+//     with_compact (minimize_dfa (make_dfa (nfa)), [&](const auto& dfa) {
+//         return match (dfa, first, last);
+//     });
+//
+template< typename F >
+inline auto
+with_compact (const dfa_t& dfa, F f) {
+    const auto n = dead_state (dfa);
+
+    if (n <= (numeric_limits< uint8_t >::max) ())
+        return f (automaton_cast< compact_dfa_t< uint8_t > > (dfa));
+
+    if (n <= (numeric_limits< uint16_t >::max) ())
+        return f (automaton_cast< compact_dfa_t< uint16_t > > (dfa));
+
+    return f (automaton_cast< compact_dfa_t< uint32_t > > (dfa));
+}
+
+//
+// Removes the states that are not reachable from the initial state and those
+// from which no accepting state is reachable, all but the initial state; the
+// others keep their relative order. An automaton without states is returned
+// as it is:
+//
+dfa_t trim (const dfa_t&);
+
+//
+// The reverse automaton, with a new initial state with epsilon transitions to
+// the former accepting states:
+//
+nfa_t reverse (const dfa_t&);
+
 dfa_t minimize_dfa_table (const dfa_t&);
+dfa_t minimize_dfa_hopcroft (const dfa_t&);
+dfa_t minimize_dfa_brzozowski (const dfa_t&);
+
+//
+// The buffers of Hopcroft's refinement: the transitions completed with the
+// dead state and their inverse, the refinable partition of the states, the
+// blocks and symbols left to split by, and the spare states of the output.
+//
+struct minimize_scratch_t {
+    vector< int > symbols;
+    vector< size_t > delta, offsets, sources, positions;
+
+    vector< size_t > elems, loc, block, first, mid, end, touched, splitting;
+
+    vector< pair< size_t, size_t > > worklist;
+    vector< bool > pending;
+
+    vector< size_t > splitter, number, queue;
+
+    vector< vector< pair< int, size_t > > > spare;
+};
+
+//
+// Same, into the automaton, whose states are reused, out of the buffers:
+//
+void minimize_dfa_hopcroft (const dfa_t&, dfa_t&, minimize_scratch_t&);
+
+//
+// Picks one of the above from the shape of the automaton:
+//
+dfa_t minimize_dfa (const dfa_t&);
+
+template< typename I, typename S >
+bool match (const basic_dfa_t< I, S >&, const char*, const char*);
+
+template< typename I, typename S >
+istream& operator>> (istream&, basic_dfa_t< I, S >&);
+
+template< typename I, typename S >
+ostream& operator<< (ostream&, const basic_dfa_t< I, S >&);
+
+//
+// Instantiated in the library for dfa_t and the compact types:
+//
+
+extern template bool match (
+    const basic_dfa_t< int, size_t >&, const char*, const char*);
+extern template istream& operator>> (
+    istream&, basic_dfa_t< int, size_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_dfa_t< int, size_t >&);
+
+extern template bool match (
+    const basic_dfa_t< uint8_t, uint8_t >&, const char*, const char*);
+extern template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint8_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint8_t >&);
+
+extern template bool match (
+    const basic_dfa_t< uint8_t, uint16_t >&, const char*, const char*);
+extern template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint16_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint16_t >&);
 
-istream& operator>> (istream&, dfa_t&);
-ostream& operator<< (ostream&, const dfa_t&);
+extern template bool match (
+    const basic_dfa_t< uint8_t, uint32_t >&, const char*, const char*);
+extern template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint32_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint32_t >&);
 
 #endif // RETA_DFA_HPP
@@ -0,0 +1,33 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_EQUIVALENCE_HPP
+#define RETA_EQUIVALENCE_HPP
+
+#include <string>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Language equivalence by Hopcroft and Karp's union-find bisimulation, without
+// minimizing either automaton. When they differ, and a string is given, it is
+// set to one accepted by exactly one of them:
+//
+bool equivalent (const dfa_t&, const dfa_t&, string* = 0);
+
+//
+// Whether the language of the first automaton includes that of the second,
+// over the pairs of their states reached breadth-first, without building the
+// product; the counterexample is a shortest string accepted by the second
+// only:
+//
+bool includes (const dfa_t&, const dfa_t&, string* = 0);
+
+//
+// Whether the automaton accepts nothing; otherwise the witness, if given, is
+// set to a shortest accepted string:
+//
+bool accepts_nothing (const dfa_t&, string* = 0);
+
+#endif // RETA_EQUIVALENCE_HPP
@@ -0,0 +1,50 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_JIT_HPP
+#define RETA_JIT_HPP
+
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+#include <reta/table.hpp>
+
+//
+// Lowers a (minimized) DFA to x86-64 machine code in an executable mapping:
+// every state is a block of direct-coded compare-and-branch instructions,
+// dense states dispatch through a jump table. Where native code generation is
+// not available (other architectures, W^X policies refusing the mapping, or
+// explicitly declined by the caller) matching falls back to the dense table.
+//
+struct jit_t {
+    explicit jit_t (const dfa_t&, bool native = true);
+    ~jit_t ();
+
+    jit_t (const jit_t&) = delete;
+    jit_t& operator= (const jit_t&) = delete;
+
+    bool native () const {
+        return fun_;
+    }
+
+    size_t size () const {
+        return size_;
+    }
+
+private:
+    friend bool match (const jit_t&, const char*, const char*);
+
+    using function_type = bool (*) (const char*, const char*);
+
+    function_type fun_;
+
+    void* code_;
+    size_t size_;
+
+    table_t table_;
+};
+
+bool match (const jit_t&, const char*, const char*);
+
+#endif // RETA_JIT_HPP
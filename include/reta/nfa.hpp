@@ -3,26 +3,243 @@
 #ifndef RETA_NFA_HPP
 #define RETA_NFA_HPP
 
+#include <cassert>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
 using namespace std;
 
-struct nfa_t {
-    using  int_type = int;
-    using size_type = size_t;
+#include <reta/utf8.hpp>
+
+//
+// The automata are templated over the types of their labels and state ids;
+// nfa_t, and dfa_t, with int labels and size_t ids, are those the algorithms
+// build and work on. The labels of an NFA must be signed and hold the anchors
+// and the tags, those of a DFA only hold bytes; narrower types take a quarter
+// of the bytes per transition or less.
+//
+template< typename IntType, typename SizeType >
+struct basic_nfa_t {
+    using  int_type = IntType;
+    using size_type = SizeType;
 
     vector< vector< pair< int_type, size_type > > > states;
     vector< size_type > accept;
     size_type start;
 
     static constexpr int_type epsilon = -1;
+
+    //
+    // Tag transitions, epsilon transitions that record the input position they
+    // are taken at, are labelled below epsilon:
+    //
+    static constexpr int_type tag (size_t i) {
+        return epsilon - 1 - int_type (i);
+    }
+
+    static constexpr bool is_epsilon (int_type c) {
+        return c <= epsilon;
+    }
+
+    //
+    // Anchors, the assertions ^ and $ of the start and of the end of the
+    // input, are labelled past the bytes:
+    //
+    static constexpr int_type begin_anchor = 256;
+    static constexpr int_type end_anchor = 257;
+
+    static constexpr bool is_symbol (int_type c) {
+        return 0 <= c && c < begin_anchor;
+    }
 };
 
+using nfa_t = basic_nfa_t< int, size_t >;
+
+//
+// The NFA with 16-bit labels and the state ids of the type:
+//
+template< typename T >
+using compact_nfa_t = basic_nfa_t< int16_t, T >;
+
+//
+// The automaton with the label and state types of another, of the same kind;
+// every label and state id must fit:
+//
+template< typename To, typename From >
+To automaton_cast (const From& src) {
+    using int_type = typename To::int_type;
+    using size_type = typename To::size_type;
+
+    const auto narrow = [](auto x, auto y) {
+        assert (decltype (x) (y) == x);
+        return y;
+    };
+
+    To dst { };
+    dst.states.resize (src.states.size ());
+
+    for (size_t i = 0; i < src.states.size (); ++i) {
+        auto& ts = dst.states [i];
+        ts.reserve (src.states [i].size ());
+
+        for (const auto& t : src.states [i])
+            ts.emplace_back (
+                narrow (t.first, int_type (t.first)),
+                narrow (t.second, size_type (t.second)));
+    }
+
+    dst.accept.reserve (src.accept.size ());
+
+    for (const auto s : src.accept)
+        dst.accept.push_back (narrow (s, size_type (s)));
+
+    dst.start = narrow (src.start, size_type (src.start));
+
+    return dst;
+}
+
+//
+// Besides the literals a to z, an expression holds classes of code points,
+// matched as their UTF-8 encodings: bracketed sets of characters, ranges and
+// escapes, e.g., [a-zà-ÿ] or [^\p{L}\p{Nd}], complemented by a leading ^;
+// single escapes, \p{..} and \P{..} for a Unicode general category and its
+// complement, \x{..} for a code point, and \ before any other character;
+// and UTF-8 characters. In postfix, a class is an operand of its ranges in
+// hexadecimal between braces, e.g., {61-7a,e0-ff}; a brace in the expression
+// is escaped. Malformed expressions, classes and UTF-8 throw invalid_argument.
+//
 string postfix (const string&);
+
+//
+// Same, into the string, with the stack as scratch; both keep their storage
+// from one call to the next:
+//
+void postfix (const string&, string&, vector< pair< size_t, size_t > >&);
+
+//
+// Rewrites a postfix expression into an equivalent one with a smaller
+// automaton: nested closures collapse, duplicate alternatives go, single
+// characters among alternatives merge into a class, and the common prefixes
+// and suffixes of alternatives are factored out. Capture expressions are left
+// as they are.
+//
+string simplify (const string&);
+
+//
+// The postfix operand of canonical ranges, and the ranges of the operand at
+// the position, left on its closing brace:
+//
+string class_operand (const code_point_ranges_t&);
+code_point_ranges_t class_ranges (const string&, size_t&);
+
+//
+// Thompson automaton; a class is compiled to the byte sequences of its UTF-8
+// encodings, with their common suffixes shared, in as many states as the
+// sequences of its ranges, however many code points they hold:
+//
 nfa_t make_nfa (const string&);
 
-istream& operator>> (istream&, nfa_t&);
-ostream& operator<< (ostream&, const nfa_t&);
+//
+// Same, into the automaton, with the stack as scratch; the states of the
+// automaton go to the spare states, transitions cleared, and those are taken
+// first, so that compiling into the same automaton over and over reuses the
+// storage of the transitions:
+//
+void make_nfa (
+    const string&, nfa_t&, vector< size_t >&,
+    vector< vector< pair< int, size_t > > >&);
+
+//
+// Postfix form with capture groups: the expression is group 0, parenthesized
+// groups are numbered from 1 in the order of their opening parenthesis, and
+// group i is enclosed by the tags 2i and 2i + 1, written as the bytes
+// capture_tag_byte + 2i and capture_tag_byte + 2i + 1, which make_nfa turns
+// into tag transitions:
+//
+constexpr unsigned char capture_tag_byte = 0x80;
+constexpr size_t max_capture_groups = 64;
+
+string postfix_captures (const string&, size_t* groups = 0);
+
+//
+// Position (Glushkov) automaton: one state per literal plus the initial state,
+// without epsilon transitions; an anchor is a position entered on the anchor.
+// Classes need the Thompson construction; here they throw invalid_argument:
+//
+nfa_t make_glushkov_nfa (const string&);
+
+enum struct construction_t {
+    thompson, glushkov
+};
+
+nfa_t make_nfa (const string&, construction_t);
+
+template< typename I, typename S >
+bool match (const basic_nfa_t< I, S >&, const char*, const char*);
+
+//
+// The active sets of the simulation, as lists and membership bitsets, kept by
+// the caller to match without allocating once they have grown to the
+// automaton; one per thread, the automaton itself is only read:
+//
+struct nfa_scratch_t {
+    vector< size_t > curr, next;
+    vector< bool > member, next_member;
+};
+
+template< typename I, typename S >
+bool match (
+    const basic_nfa_t< I, S >&, const char*, const char*, nfa_scratch_t&);
+
+template< typename I, typename S >
+istream& operator>> (istream&, basic_nfa_t< I, S >&);
+
+template< typename I, typename S >
+ostream& operator<< (ostream&, const basic_nfa_t< I, S >&);
+
+//
+// Instantiated in the library for nfa_t and the compact types:
+//
+extern template bool match (
+    const basic_nfa_t< int, size_t >&, const char*, const char*);
+extern template bool match (
+    const basic_nfa_t< int, size_t >&, const char*, const char*,
+    nfa_scratch_t&);
+extern template istream& operator>> (
+    istream&, basic_nfa_t< int, size_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_nfa_t< int, size_t >&);
+
+extern template bool match (
+    const basic_nfa_t< int16_t, uint8_t >&, const char*, const char*);
+extern template bool match (
+    const basic_nfa_t< int16_t, uint8_t >&, const char*, const char*,
+    nfa_scratch_t&);
+extern template istream& operator>> (
+    istream&, basic_nfa_t< int16_t, uint8_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint8_t >&);
+
+extern template bool match (
+    const basic_nfa_t< int16_t, uint16_t >&, const char*, const char*);
+extern template bool match (
+    const basic_nfa_t< int16_t, uint16_t >&, const char*, const char*,
+    nfa_scratch_t&);
+extern template istream& operator>> (
+    istream&, basic_nfa_t< int16_t, uint16_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint16_t >&);
+
+extern template bool match (
+    const basic_nfa_t< int16_t, uint32_t >&, const char*, const char*);
+extern template bool match (
+    const basic_nfa_t< int16_t, uint32_t >&, const char*, const char*,
+    nfa_scratch_t&);
+extern template istream& operator>> (
+    istream&, basic_nfa_t< int16_t, uint32_t >&);
+extern template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint32_t >&);
 
 #endif // RETA_NFA_HPP
@@ -0,0 +1,30 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_PARALLEL_HPP
+#define RETA_PARALLEL_HPP
+
+#include <vector>
+
+using namespace std;
+
+#include <reta/table.hpp>
+
+//
+// The mapping of every state of the table, the dead state included, to the
+// state the input leads it to. All states are run in lockstep; those that
+// reach the same state merge, and once a single one is left it runs alone.
+// Minimal DFAs tend to synchronize within a few bytes.
+//
+vector< size_t > scan_all (const table_t&, const char*, const char*);
+
+//
+// Splits the input into chunks scanned on as many threads. The first chunk is
+// run from the initial state, the others from all states, and the mappings are
+// composed in order. The outcome is the same as the serial match; inputs too
+// small to amortize the threads are matched serially. Zero threads means one
+// per hardware thread.
+//
+bool match_parallel (
+    const table_t&, const char*, const char*, size_t threads = 0);
+
+#endif // RETA_PARALLEL_HPP
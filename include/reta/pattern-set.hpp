@@ -0,0 +1,92 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_PATTERN_SET_HPP
+#define RETA_PATTERN_SET_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Minimal acyclic automaton of a set of literal patterns, kept minimal across
+// insertions and removals (Carrasco and Forcada's extension of Daciuk's
+// incremental construction to unsorted input and removal). Equivalent states
+// are merged through a register of state signatures; only the states along the
+// path of the pattern are unregistered, cloned where shared, and merged back.
+//
+struct pattern_set_t {
+    pattern_set_t ();
+
+    //
+    // Both return false, and leave the automaton untouched, when the pattern
+    // is already in, respectively not in, the set:
+    //
+    bool insert (const string&);
+    bool erase (const string&);
+
+    bool contains (const string&) const;
+
+    size_t size () const {
+        return size_;
+    }
+
+    //
+    // Live states of the automaton, and the states created, cloned, modified
+    // or released by the last insertion or removal:
+    //
+    size_t states () const {
+        return states_.size () - free_.size ();
+    }
+
+    size_t touched () const {
+        return touched_;
+    }
+
+    //
+    // Reachable states numbered breadth-first from the initial state:
+    //
+    dfa_t to_dfa () const;
+
+private:
+    struct state_t {
+        vector< pair< int, size_t > > next;
+        bool final;
+        size_t in;
+        bool registered;
+    };
+
+    struct hash_t {
+        size_t operator() (const state_t&) const;
+    };
+
+    struct equal_t {
+        bool operator() (const state_t&, const state_t&) const;
+    };
+
+    size_t make_state ();
+    size_t clone (size_t);
+    void release (size_t);
+
+    void unregister (size_t);
+
+    size_t target (size_t, int) const;
+    void set_target (size_t, int, size_t);
+    void remove_target (size_t, int);
+
+    vector< size_t > prepare (const string&);
+    void merge (const vector< size_t >&, const string&);
+
+private:
+    vector< state_t > states_;
+    vector< size_t > free_;
+
+    unordered_map< state_t, size_t, hash_t, equal_t > register_;
+
+    size_t root_, size_, touched_;
+};
+
+#endif // RETA_PATTERN_SET_HPP
@@ -0,0 +1,25 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_PRODUCT_HPP
+#define RETA_PRODUCT_HPP
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Boolean combinations of automata, by product construction: only the pairs
+// of states reachable from the pair of initial states are explored, and those
+// from which no accepting pair is reachable are dropped. The result is
+// minimized on request.
+//
+dfa_t intersect (const dfa_t&, const dfa_t&, bool minimize = false);
+dfa_t unite (const dfa_t&, const dfa_t&, bool minimize = false);
+dfa_t difference (const dfa_t&, const dfa_t&, bool minimize = false);
+
+//
+// Against the alphabet of all bytes:
+//
+dfa_t complement (const dfa_t&, bool minimize = false);
+
+#endif // RETA_PRODUCT_HPP
@@ -0,0 +1,115 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_REGEX_HPP
+#define RETA_REGEX_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+#include <reta/nfa.hpp>
+#include <reta/table.hpp>
+#include <reta/tdfa.hpp>
+
+//
+// Thread safety: the automata and tables of the library are plain values,
+// never changed by matching, so that any number of threads may match against
+// one at once; the matchers that need scratch, the NFA simulation and the
+// TDFA registers, allocate it per call or take it from the caller. Building
+// and changing them is not synchronized, nor are the compiler and the pattern
+// set, which change as they go.
+//
+// A compiled expression: the dense table of its minimal DFA, or, when the DFA
+// is over the bounds of the options, its NFA, which is simulated; and, on
+// request, the TDFA of its groups. It is immutable once built and shared as a
+// reference-counted handle to const, copied across threads without locks.
+// Every engine matches the whole input: the bounds of the DFA options apply,
+// the search options, unanchored and earliest, are ignored.
+//
+struct regex_options_t {
+    dfa_options_t dfa;
+    bool captures = false;
+};
+
+struct compiled_regex_t {
+    string pattern;
+
+    nfa_t nfa;
+
+    //
+    // Null past the bounds, and without captures, respectively:
+    //
+    unique_ptr< const table_t > table;
+    unique_ptr< const tdfa_t > tdfa;
+};
+
+using regex_handle_t = shared_ptr< const compiled_regex_t >;
+
+regex_handle_t
+compile_regex (const string&, const regex_options_t& = regex_options_t { });
+
+//
+// The mutable state of a match, used by one thread at a time. It is aligned
+// on a cache line, and its buffers grow in the thread that uses it, so that
+// the scratch of a thread shares no line with that of another:
+//
+struct alignas (64) match_scratch_t {
+    nfa_scratch_t nfa;
+    vector< ptrdiff_t > registers;
+};
+
+bool match (
+    const compiled_regex_t&, const char*, const char*, match_scratch_t&);
+
+//
+// Needs the captures of the options, throws logic_error without them:
+//
+bool match (
+    const compiled_regex_t&, const char*, const char*, captures_t&,
+    match_scratch_t&);
+
+//
+// Scratch handed out to threads and taken back, for a thread to hold for as
+// many matches as it runs: the lock is taken once per lease, not per match. A
+// scratch is created in the thread that first leases it.
+//
+struct scratch_pool_t {
+    struct lease_t {
+        lease_t (scratch_pool_t&, unique_ptr< match_scratch_t >);
+
+        lease_t (lease_t&&) = default;
+        ~lease_t ();
+
+        match_scratch_t& operator* () const {
+            return *scratch_;
+        }
+
+        match_scratch_t* operator-> () const {
+            return scratch_.get ();
+        }
+
+    private:
+        scratch_pool_t* pool_;
+        unique_ptr< match_scratch_t > scratch_;
+    };
+
+    lease_t acquire ();
+
+    //
+    // The scratch created so far, leased or not:
+    //
+    size_t size () const;
+
+private:
+    mutable mutex mutex_;
+
+    vector< unique_ptr< match_scratch_t > > free_;
+    size_t size_ = 0;
+};
+
+#endif // RETA_REGEX_HPP
@@ -0,0 +1,39 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_RENUMBER_HPP
+#define RETA_RENUMBER_HPP
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Static state orders for the layout of transition tables: breadth-first keeps
+// the states near the initial one, where most inputs stay, together;
+// depth-first keeps chains of states, e.g., literals, on consecutive rows.
+//
+enum struct order_t {
+    bfs, dfs
+};
+
+//
+// Visit counts of the states over the sample input, one count per state:
+//
+vector< size_t > profile (const dfa_t&, const vector< string >&);
+
+//
+// Renumbers the states, transitions visited in symbol order; the states the
+// order does not reach keep their relative order after the others:
+//
+dfa_t renumber (const dfa_t&, order_t);
+
+//
+// Profile-guided, by decreasing visit count, ties broken by the breadth-first
+// order:
+//
+dfa_t renumber (const dfa_t&, const vector< size_t >&);
+
+#endif // RETA_RENUMBER_HPP
@@ -0,0 +1,102 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_STATS_HPP
+#define RETA_STATS_HPP
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include <reta/config.hpp>
+
+//
+// Construction statistics, collected per thread into the stats_t installed by
+// the innermost stats_scope_t. The hooks are compiled in only when the library
+// is configured with --enable-stats (RETA_STATS), otherwise the counters stay
+// zero and the hooks cost nothing.
+//
+struct stats_t {
+    using duration_type = chrono::nanoseconds;
+
+    struct stage_t {
+        duration_type wall { };
+        size_t calls = 0;
+    };
+
+    stage_t postfix, make_nfa, make_dfa, minimize;
+
+    size_t nfa_states = 0, nfa_transitions = 0;
+    size_t dfa_states = 0, dfa_transitions = 0;
+
+    //
+    // Closure sizes, bucket k counting the closures of [2^k, 2^(k+1)) states:
+    //
+    vector< size_t > closure_sizes;
+
+    //
+    // Passes over the minimization table until it reaches its fixpoint:
+    //
+    size_t minimization_sweeps = 0;
+
+    //
+    // High-water mark of the estimated bytes held by a construction stage:
+    //
+    size_t peak_bytes = 0;
+
+    //
+    // Lookups of closures in the table of interned DFA states:
+    //
+    size_t intern_hits = 0, intern_misses = 0;
+
+    //
+    // States removed by trim, unreachable from the initial state or unable to
+    // reach an accepting one:
+    //
+    size_t trimmed_unreachable = 0, trimmed_dead = 0;
+
+    static stats_t* current ();
+
+    void closure (size_t);
+    void bytes (size_t);
+};
+
+ostream& operator<< (ostream&, const stats_t&);
+
+struct stats_scope_t {
+    explicit stats_scope_t (stats_t&);
+    ~stats_scope_t ();
+
+    stats_scope_t (const stats_scope_t&) = delete;
+    stats_scope_t& operator= (const stats_scope_t&) = delete;
+
+private:
+    stats_t* prev_;
+};
+
+struct stats_timer_t {
+    explicit stats_timer_t (stats_t::stage_t stats_t::*);
+    ~stats_timer_t ();
+
+private:
+    stats_t::stage_t stats_t::*stage_;
+    chrono::steady_clock::time_point start_;
+};
+
+#if defined (RETA_STATS)
+#  define RETA_STATS_TIMER(stage)                                   \
+    stats_timer_t reta_stats_timer_ (&stats_t::stage)
+#  define RETA_STATS_UPDATE(x)                                      \
+    do {                                                            \
+        if (stats_t* const reta_stats_ = stats_t::current ()) {     \
+            stats_t& stats = *reta_stats_;                          \
+            x;                                                      \
+        }                                                           \
+    } while (0)
+#else
+#  define RETA_STATS_TIMER(stage)
+#  define RETA_STATS_UPDATE(x) do { } while (0)
+#endif // RETA_STATS
+
+#endif // RETA_STATS_HPP
@@ -0,0 +1,80 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_TABLE_HPP
+#define RETA_TABLE_HPP
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// Dense [state][byte] transition table; missing transitions go to an explicit
+// dead state which is appended after the states of the source automaton.
+//
+struct table_t {
+    using size_type = size_t;
+
+    static constexpr size_type width = 256;
+
+    explicit table_t (const dfa_t&);
+
+    vector< size_type > next;
+    vector< bool > accept;
+    size_type start, dead;
+};
+
+bool match (const table_t&, const char*, const char*);
+
+//
+// Two-tier table: the rows of the first states, the hot ones after a profile
+// renumbering, are narrowed to 16-bit targets small enough to stay in the L1
+// cache; a transition out of them to a state that is not hot escapes to the
+// full table, which holds the rest.
+//
+struct tiered_table_t {
+    using size_type = size_t;
+    using hot_type = uint16_t;
+
+    static constexpr hot_type escape = hot_type (-1);
+
+    //
+    // 64 hot rows of 256 16-bit targets take 32 KiB:
+    //
+    static constexpr size_type default_hot_bytes = 32 * 1024;
+
+    explicit tiered_table_t (const dfa_t&, size_type = default_hot_bytes);
+
+    vector< hot_type > hot;
+    size_type hot_states;
+
+    table_t cold;
+};
+
+bool match (const tiered_table_t&, const char*, const char*);
+
+//
+// Dense table of a search automaton, one made unanchored and earliest: the
+// scan stops at the first byte that completes a match, in the accepting sink,
+// or as soon as no match can follow, in the dead state.
+//
+struct search_table_t {
+    using size_type = table_t::size_type;
+
+    static constexpr size_type npos = size_type (-1);
+
+    explicit search_table_t (const dfa_t&);
+
+    table_t table;
+
+    //
+    // The accepting state that loops on all bytes, npos if none:
+    //
+    size_type sink;
+};
+
+bool search (const search_table_t&, const char*, const char*);
+
+#endif // RETA_TABLE_HPP
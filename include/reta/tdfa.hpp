@@ -0,0 +1,73 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_TDFA_HPP
+#define RETA_TDFA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+
+//
+// Tagged DFA (Laurikari): the subset construction over a tagged NFA, whose
+// states are ordered lists of NFA states, each with the registers holding the
+// values of its tags along its path. Transitions carry register operations,
+// copies and stores of the current position, so that submatch boundaries are
+// recorded in a single pass over the input, without backtracking.
+//
+// Ambiguities are resolved leftmost-greedy, as a backtracking matcher would:
+// the left alternative first, closures as many iterations as possible, a
+// group inside a closure holding its last iteration.
+//
+struct tdfa_t {
+    using size_type = uint32_t;
+
+    static constexpr size_type width = 256;
+
+    //
+    // Register operations, pairs of a destination and a source, the current
+    // position for a source of position:
+    //
+    using op_type = pair< size_type, size_type >;
+
+    static constexpr size_type position = size_type (-1);
+
+    //
+    // Dense tables of the targets and of the operations of the transitions,
+    // with the dead state last; the operations 0 are empty:
+    //
+    vector< size_type > next, action;
+    vector< vector< op_type > > actions;
+
+    //
+    // The operations before the first byte, and, for the accepting states, the
+    // registers holding every tag (empty for the other states):
+    //
+    vector< op_type > initial;
+    vector< vector< size_type > > final;
+
+    size_type start, dead;
+    size_t tags, registers;
+};
+
+tdfa_t make_tdfa (const nfa_t&, size_t tags);
+
+//
+// Group boundaries as offsets in the input, -1 for groups that take no part in
+// the match; group 0 is the whole input:
+//
+using captures_t = vector< pair< ptrdiff_t, ptrdiff_t > >;
+
+bool match (const tdfa_t&, const char*, const char*, captures_t&);
+
+//
+// Same, with the registers kept by the caller, one set per thread:
+//
+bool match (
+    const tdfa_t&, const char*, const char*, captures_t&,
+    vector< ptrdiff_t >&);
+
+#endif // RETA_TDFA_HPP
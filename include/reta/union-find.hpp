@@ -0,0 +1,58 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_UNION_FIND_HPP
+#define RETA_UNION_FIND_HPP
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// Disjoint sets over 0..n-1, union by rank and path halving, near-constant
+// amortized time per operation:
+//
+struct union_find_t {
+    explicit union_find_t (size_t n) : parent_ (n), rank_ (n) {
+        for (size_t i = 0; i < n; ++i)
+            parent_ [i] = i;
+    }
+
+    size_t find (size_t x) {
+        while (parent_ [x] != x)
+            x = parent_ [x] = parent_ [parent_ [x]];
+
+        return x;
+    }
+
+    //
+    // Returns false if both were already in the same set:
+    //
+    bool unite (size_t x, size_t y) {
+        x = find (x);
+        y = find (y);
+
+        if (x == y)
+            return false;
+
+        if (rank_ [x] < rank_ [y])
+            swap (x, y);
+
+        parent_ [y] = x;
+
+        if (rank_ [x] == rank_ [y])
+            ++rank_ [x];
+
+        return true;
+    }
+
+    size_t size () const {
+        return parent_.size ();
+    }
+
+private:
+    vector< size_t > parent_;
+    vector< unsigned char > rank_;
+};
+
+#endif // RETA_UNION_FIND_HPP
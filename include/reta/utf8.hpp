@@ -0,0 +1,51 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_UTF8_HPP
+#define RETA_UTF8_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t max_code_point = 0x10ffff;
+
+//
+// Closed ranges of code points; canonical once sorted, disjoint and not
+// adjacent:
+//
+using code_point_ranges_t = vector< pair< uint32_t, uint32_t > >;
+
+void canonicalize (code_point_ranges_t&);
+
+//
+// The code points not in the canonical ranges:
+//
+code_point_ranges_t complement (const code_point_ranges_t&);
+
+//
+// The ranges of a Unicode general category, by its short name, e.g., L or Nd:
+//
+bool unicode_property (const string&, code_point_ranges_t&);
+
+string encode_utf8 (uint32_t);
+
+//
+// Decodes the code point the input starts with, and advances past it; fails on
+// truncated, overlong and surrogate sequences:
+//
+bool decode_utf8 (const char*&, const char*, uint32_t&);
+
+//
+// The UTF-8 encodings of a range of code points, as sequences of byte ranges,
+// one per byte, such that every sequence of bytes in the ranges, position by
+// position, encodes a code point in the range and vice versa, as RE2 compiles
+// them. A range of a few code points or of a few hundred thousand yields at
+// most a couple dozen sequences; the surrogates are left out.
+//
+using utf8_sequence_t = vector< pair< uint8_t, uint8_t > >;
+
+vector< utf8_sequence_t > utf8_sequences (uint32_t, uint32_t);
+
+#endif // RETA_UTF8_HPP
@@ -3,6 +3,8 @@
 #ifndef RETA_UTIL_HPP
 #define RETA_UTIL_HPP
 
+#include <vector>
+
 using namespace std;
 
 template< typename T >
@@ -10,4 +12,29 @@ inline size_t size_cast (T c) {
     return size_t (typename make_unsigned< T >::type (c));
 }
 
+//
+// The states of an automaton built into over and over: they go to the spare
+// ones, transitions cleared, and states are taken from those first, so that
+// the storage of the transitions is reused from one build to the next:
+//
+template< typename T >
+inline void spare_states (vector< T >& states, vector< T >& spare) {
+    for (auto& ts : states) {
+        ts.clear ();
+        spare.push_back (move (ts));
+    }
+
+    states.clear ();
+}
+
+template< typename T >
+inline void add_states (vector< T >& states, vector< T >& spare, size_t n) {
+    for (; n && !spare.empty (); --n) {
+        states.push_back (move (spare.back ()));
+        spare.pop_back ();
+    }
+
+    states.resize (states.size () + n);
+}
+
 #endif // RETA_UTIL_HPP
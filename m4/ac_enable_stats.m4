@@ -0,0 +1,17 @@
+dnl -*- Autoconf -*-
+
+AC_DEFUN([AC_ENABLE_STATS],[
+
+AC_ARG_ENABLE([stats],
+    [AS_HELP_STRING([--enable-stats],[collect construction statistics])],
+    [],
+    [enable_stats=no])
+
+AC_MSG_CHECKING([whether to collect construction statistics])
+
+if test "x${enable_stats}" = xyes; then
+  AC_DEFINE([RETA_STATS],[1],[Define to collect construction statistics])
+fi
+
+AC_MSG_RESULT([${enable_stats}])
+])
@@ -0,0 +1,411 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/aho-corasick.hpp>
+
+#if defined (__x86_64__) && defined (__GNUC__)
+#  define RETA_TEDDY_SSSE3 1
+#  include <tmmintrin.h>
+#endif // __x86_64__
+
+bool
+literals_of (const string& s, vector< string >& result, size_t max_literals) {
+    vector< vector< string > > st;
+
+    for (const auto c : s) {
+        if ('.' == c) {
+            assert (st.size () > 1);
+
+            auto rhs = move (st.back ());
+            st.pop_back ();
+
+            auto& lhs = st.back ();
+
+            if (lhs.size () * rhs.size () > max_literals)
+                return false;
+
+            vector< string > v;
+            v.reserve (lhs.size () * rhs.size ());
+
+            for (const auto& a : lhs)
+                for (const auto& b : rhs)
+                    v.push_back (a + b);
+
+            lhs = move (v);
+        }
+        else if ('|' == c) {
+            assert (st.size () > 1);
+
+            auto rhs = move (st.back ());
+            st.pop_back ();
+
+            auto& lhs = st.back ();
+
+            if (lhs.size () + rhs.size () > max_literals)
+                return false;
+
+            //
+            // The order does not matter until the final sort, the smaller
+            // side is moved into the larger:
+            //
+            if (lhs.size () < rhs.size ())
+                swap (lhs, rhs);
+
+            lhs.insert (
+                lhs.end (), make_move_iterator (rhs.begin ()),
+                make_move_iterator (rhs.end ()));
+        }
+        else if ('*' == c || '^' == c || '$' == c || '{' == c)
+            return false;
+        else
+            st.push_back ({ string (1, c) });
+    }
+
+    if (st.size () != 1)
+        return false;
+
+    result = move (st.back ());
+
+    sort (result.begin (), result.end ());
+    result.erase (unique (result.begin (), result.end ()), result.end ());
+
+    return true;
+}
+
+namespace detail {
+
+static inline bool
+has_ssse3 () {
+#if defined (RETA_TEDDY_SSSE3)
+    return __builtin_cpu_supports ("ssse3");
+#else
+    return false;
+#endif // RETA_TEDDY_SSSE3
+}
+
+//
+// The trie of the literals, whose children come in byte order because the
+// literals are sorted:
+//
+struct trie_t {
+    explicit trie_t (const vector< string >& literals)
+        : next (1), final (1) {
+        for (const auto& s : literals) {
+            size_t u = 0;
+
+            for (const auto c : s) {
+                const auto b = (unsigned char)c;
+                auto& ts = next [u];
+
+                if (ts.empty () || ts.back ().first != b) {
+                    ts.emplace_back (b, next.size ());
+
+                    next.emplace_back ();
+                    final.push_back (false);
+                }
+
+                u = next [u].back ().second;
+            }
+
+            final [u] = true;
+        }
+    }
+
+    vector< vector< pair< unsigned char, size_t > > > next;
+    vector< bool > final;
+};
+
+//
+// The free slots of the double array: every taken slot points to a slot not
+// past the first free one after it, the paths compressed by the lookups.
+//
+struct free_slots_t {
+    free_slots_t () : extent () { }
+
+    bool free (size_t i) const {
+        return i >= next.size () || next [i] == i;
+    }
+
+    size_t find (size_t i) {
+        size_t j = i;
+        for (; !free (j); j = next [j]) ;
+
+        for (; i != j; ) {
+            const auto k = next [i];
+            next [i] = j;
+            i = k;
+        }
+
+        return j;
+    }
+
+    void take (size_t i) {
+        if (next.size () <= i) {
+            const auto n = next.size ();
+
+            next.resize (i + 1);
+            iota (next.begin () + n, next.end (), n);
+        }
+
+        next [i] = i + 1;
+        extent = (max) (extent, i + 1);
+    }
+
+    vector< size_t > next;
+    size_t extent;
+};
+
+} // namespace detail
+
+aho_corasick_t::aho_corasick_t (const vector< string >& xs, bool prefilter)
+    : start (), fingerprint (), states_ () {
+    literals = xs;
+
+    sort (literals.begin (), literals.end ());
+    literals.erase (
+        unique (literals.begin (), literals.end ()), literals.end ());
+
+    const detail::trie_t trie (literals);
+    states_ = trie.next.size ();
+
+    //
+    // Places the children of every trie state, breadth-first, at the first
+    // offset where all their slots are free; the root owns slot zero:
+    //
+    vector< size_type > slot (states_);
+
+    detail::free_slots_t slots;
+    slots.take (0);
+
+    vector< size_t > q (1, 0);
+    q.reserve (states_);
+
+    for (size_t i = 0; i < q.size (); ++i) {
+        const auto u = q [i];
+        const auto& ts = trie.next [u];
+
+        if (ts.empty ())
+            continue;
+
+        //
+        // Only offsets that put the first child in a free slot are tried:
+        //
+        const size_t c = ts.front ().first;
+
+        size_t b = slots.find (c) - c;
+
+        for (; !all_of (ts.begin () + 1, ts.end (), [&](const auto& t) {
+                    return slots.free (b + t.first);
+                }); b = slots.find (b + c + 1) - c) ;
+
+        if (base.size () < b + 256)
+            base.resize (b + 256);
+
+        base [slot [u]] = size_type (b);
+
+        for (const auto& t : ts) {
+            slots.take (b + t.first);
+            slot [t.second] = size_type (b + t.first);
+
+            q.push_back (t.second);
+        }
+    }
+
+    const auto n = slots.extent;
+
+    base.resize (n);
+    check.assign (n, none);
+
+    fail.assign (n, 0);
+    terminal.assign (n, false);
+
+    for (size_t u = 0; u < states_; ++u) {
+        for (const auto& t : trie.next [u])
+            check [slot [t.second]] = slot [u];
+
+        terminal [slot [u]] = trie.final [u];
+    }
+
+    //
+    // Failure links, breadth-first: the failure of a child of s by c is the
+    // child by c of the longest proper suffix state of s that has one:
+    //
+    output = terminal;
+
+    for (const auto u : q) {
+        const auto s = slot [u];
+
+        for (const auto& t : trie.next [u]) {
+            const auto x = slot [t.second];
+
+            if (s != start) {
+                auto f = fail [s];
+
+                for (; f != start && none == next (f, t.first); f = fail [f]) ;
+
+                const auto y = next (f, t.first);
+                fail [x] = none == y ? start : y;
+            }
+
+            if (output [fail [x]])
+                output [x] = true;
+        }
+    }
+
+    //
+    // The prefilter spreads the sorted literals over the buckets in runs, so
+    // that those sharing a prefix, and flagged by the same positions, share a
+    // bucket:
+    //
+    if (!prefilter || !detail::has_ssse3 () || literals.empty () ||
+        literals.size () > teddy_max_literals)
+        return;
+
+    size_t m = 3;
+
+    for (const auto& s : literals)
+        m = (min) (m, s.size ());
+
+    if (0 == m)
+        return;
+
+    fingerprint = m;
+
+    lo.assign (m * 16, 0);
+    hi.assign (m * 16, 0);
+
+    buckets.resize (teddy_buckets);
+
+    for (size_t i = 0; i < literals.size (); ++i) {
+        const auto k = i * teddy_buckets / literals.size ();
+        buckets [k].push_back (i);
+
+        for (size_t j = 0; j < m; ++j) {
+            const auto c = (unsigned char)literals [i][j];
+
+            lo [j * 16 + (c & 15)] |= uint8_t (1U << k);
+            hi [j * 16 + (c >> 4)] |= uint8_t (1U << k);
+        }
+    }
+}
+
+bool
+match (const aho_corasick_t& ac, const char* first, const char* last) {
+    auto s = ac.start;
+
+    for (; first != last; ++first)
+        if (aho_corasick_t::none == (s = ac.next (s, *first)))
+            return false;
+
+    return ac.terminal [s];
+}
+
+namespace detail {
+
+#if defined (RETA_TEDDY_SSSE3)
+
+//
+// Scans the input 16 positions at a time while the fingerprint bytes of all of
+// them can be loaded, and leaves the input where the scalar search resumes:
+//
+__attribute__ ((target ("ssse3")))
+static bool
+teddy (const aho_corasick_t& ac, const char*& first, const char* last) {
+    const auto m = ac.fingerprint;
+    assert (0 < m && m <= 3);
+
+    const auto nibble = _mm_set1_epi8 (0x0f), zero = _mm_setzero_si128 ();
+
+    __m128i lo [3], hi [3];
+
+    for (size_t j = 0; j < m; ++j) {
+        lo [j] = _mm_loadu_si128 ((const __m128i*)(ac.lo.data () + j * 16));
+        hi [j] = _mm_loadu_si128 ((const __m128i*)(ac.hi.data () + j * 16));
+    }
+
+    for (; size_t (last - first) >= 16 + m - 1; first += 16) {
+        auto r = _mm_set1_epi8 (-1);
+
+        for (size_t j = 0; j < m; ++j) {
+            const auto v = _mm_loadu_si128 ((const __m128i*)(first + j));
+
+            const auto a = _mm_shuffle_epi8 (lo [j], _mm_and_si128 (v, nibble));
+            const auto b = _mm_shuffle_epi8 (
+                hi [j], _mm_and_si128 (_mm_srli_epi16 (v, 4), nibble));
+
+            r = _mm_and_si128 (r, _mm_and_si128 (a, b));
+        }
+
+        unsigned bits = ~unsigned (
+            _mm_movemask_epi8 (_mm_cmpeq_epi8 (r, zero))) & 0xffff;
+
+        if (0 == bits)
+            continue;
+
+        alignas (16) uint8_t masks [16];
+        _mm_store_si128 ((__m128i*)masks, r);
+
+        for (; bits; bits &= bits - 1) {
+            const auto i = __builtin_ctz (bits);
+            const char* const p = first + i;
+
+            for (unsigned b = masks [i]; b; b &= b - 1)
+                for (const auto k : ac.buckets [__builtin_ctz (b)]) {
+                    const auto& s = ac.literals [k];
+
+                    if (s.size () <= size_t (last - p) &&
+                        0 == memcmp (p, s.data (), s.size ()))
+                        return true;
+                }
+        }
+    }
+
+    return false;
+}
+
+#endif // RETA_TEDDY_SSSE3
+
+} // namespace detail
+
+bool
+search (const aho_corasick_t& ac, const char* first, const char* last) {
+    if (ac.output [ac.start])
+        return true;
+
+#if defined (RETA_TEDDY_SSSE3)
+    if (ac.fingerprint && detail::teddy (ac, first, last))
+        return true;
+#endif // RETA_TEDDY_SSSE3
+
+    //
+    // The positions before the prefilter stopped have been verified as starts
+    // of literals, the search only looks for literals starting after:
+    //
+    auto s = ac.start;
+
+    for (; first != last; ++first) {
+        const auto c = (unsigned char)*first;
+
+        auto t = ac.next (s, c);
+
+        for (; aho_corasick_t::none == t && s != ac.start; t = ac.next (s, c))
+            s = ac.fail [s];
+
+        s = aho_corasick_t::none == t ? ac.start : t;
+
+        if (ac.output [s])
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,29 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/compiler.hpp>
+
+void
+compiler_t::compile (const string& r, dfa_t& dfa) {
+    postfix (r, postfix_, postfix_stack_);
+    make_nfa (postfix_, nfa_, nfa_stack_, spare_);
+
+    const auto status = make_dfa (nfa_, dfa_options_t { }, dfa_, dfa_scratch_);
+    assert (dfa_status_t::ok == status);
+
+    minimize_dfa_hopcroft (dfa_, dfa, minimize_scratch_);
+}
+
+dfa_t
+compiler_t::compile (const string& r) {
+    dfa_t dfa;
+    compile (r, dfa);
+
+    return dfa;
+}
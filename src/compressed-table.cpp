@@ -0,0 +1,173 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+#include <reta/compressed-table.hpp>
+
+namespace detail {
+
+template< typename T >
+static inline void
+check_width (const dfa_t& dfa) {
+    assert (dead_state (dfa) <= (numeric_limits< T >::max) ());
+    (void)dfa;
+}
+
+static inline vector< bool >
+final_states_of (const dfa_t& dfa) {
+    //
+    // The dead state, last, does not accept:
+    //
+    vector< bool > v (dfa.states.size () + 1);
+
+    for (const auto s : dfa.accept)
+        v [s] = true;
+
+    return v;
+}
+
+} // namespace detail
+
+template< typename T >
+dense_table_t< T >::dense_table_t (const dfa_t& dfa)
+    : accept (detail::final_states_of (dfa)),
+      start (T (dfa.start)), dead (T (dead_state (dfa))) {
+    detail::check_width< T > (dfa);
+
+    targets.resize ((size_t (dead) + 1) * width, dead);
+
+    for (size_t i = 0; i < dfa.states.size (); ++i)
+        for (const auto& t : dfa.states [i]) {
+            assert (0 <= t.first && size_t (t.first) < width);
+            targets [i * width + t.first] = T (t.second);
+        }
+}
+
+template< typename T >
+comb_table_t< T >::comb_table_t (const dfa_t& dfa)
+    : accept (detail::final_states_of (dfa)),
+      start (T (dfa.start)), dead (T (dead_state (dfa))) {
+    detail::check_width< T > (dfa);
+
+    const auto n = dfa.states.size ();
+
+    //
+    // The default of a state is the most frequent target of its complete row,
+    // counting the dead state for the missing transitions:
+    //
+    defaults.assign (n + 1, dead);
+
+    vector< vector< pair< int, size_t > > > rows (n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const auto& ts = dfa.states [i];
+
+        vector< size_t > targets;
+
+        for (const auto& t : ts)
+            targets.push_back (t.second);
+
+        sort (targets.begin (), targets.end ());
+
+        size_t best = dead, count = width - ts.size ();
+
+        for (size_t j = 0, k; j < targets.size (); j = k) {
+            for (k = j; k < targets.size () && targets [k] == targets [j]; ++k)
+                ;
+
+            if (k - j > count) {
+                best = targets [j];
+                count = k - j;
+            }
+        }
+
+        defaults [i] = T (best);
+
+        for (int c = 0, k = 0; c < int (width); ++c) {
+            auto to = size_t (dead);
+
+            if (size_t (k) < ts.size () && ts [k].first == c)
+                to = ts [k++].second;
+
+            if (to != best)
+                rows [i].emplace_back (c, to);
+        }
+    }
+
+    //
+    // First fit, the fullest rows first:
+    //
+    vector< size_t > order (n);
+    iota (order.begin (), order.end (), size_t ());
+
+    stable_sort (order.begin (), order.end (), [&](auto lhs, auto rhs) {
+            return rows [lhs].size () > rows [rhs].size ();
+        });
+
+    base.assign (n + 1, 0);
+
+    vector< bool > used;
+
+    //
+    // Everything below the first free slot is taken, the search for a row
+    // starts where its first transition would land there:
+    //
+    size_t first_free = 0;
+
+    for (const auto i : order) {
+        const auto& row = rows [i];
+
+        if (row.empty ())
+            continue;
+
+        size_t b = first_free - (min) (first_free, size_t (row.front ().first));
+
+        for (;; ++b) {
+            if (used.size () < b + width)
+                used.resize (b + width);
+
+            if (all_of (row.begin (), row.end (), [&](const auto& t) {
+                        return !used [b + t.first];
+                    }))
+                break;
+        }
+
+        base [i] = uint32_t (b);
+
+        for (const auto& t : row)
+            used [b + t.first] = true;
+
+        while (first_free < used.size () && used [first_free])
+            ++first_free;
+    }
+
+    //
+    // The slots nobody owns belong to the dead state, and lead to it, so that
+    // the dead state at offset 0 goes nowhere else:
+    //
+    const auto size = (max) (used.size (), width);
+
+    check.assign (size, dead);
+    targets.assign (size, dead);
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& t : rows [i]) {
+            check [base [i] + t.first] = T (i);
+            targets [base [i] + t.first] = T (t.second);
+        }
+}
+
+template struct dense_table_t< uint8_t >;
+template struct dense_table_t< uint16_t >;
+template struct dense_table_t< uint32_t >;
+
+template struct comb_table_t< uint8_t >;
+template struct comb_table_t< uint16_t >;
+template struct comb_table_t< uint32_t >;
@@ -0,0 +1,489 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include <reta/derivative.hpp>
+#include <reta/stats.hpp>
+
+static constexpr size_t alphabet_size = 256;
+
+size_t
+expressions_t::hash_t::operator() (const node_t& node) const {
+    size_t h = hash< int > () (node.kind) * 31 + hash< int > () (node.symbol);
+
+    for (const auto n : node.args)
+        h = h * 31 + hash< size_t > () (n);
+
+    return h;
+}
+
+bool
+expressions_t::equal_t::operator() (
+    const node_t& lhs, const node_t& rhs) const {
+    return
+        lhs.kind == rhs.kind &&
+        lhs.symbol == rhs.symbol &&
+        lhs.args == rhs.args;
+}
+
+expressions_t::expressions_t () : hits_ () {
+    empty_ = intern (empty, 0, { });
+    epsilon_ = intern (epsilon, 0, { });
+    universe_ = intern (complement, 0, { empty_ });
+    begin_ = intern (begin_anchor, 0, { });
+    end_ = intern (end_anchor, 0, { });
+}
+
+expressions_t::node_type
+expressions_t::intern (kind_t kind, int c, vector< node_type > args) {
+    bool nullable = false, accepting = false;
+
+    switch (kind) {
+    case empty:
+    case symbol:
+    case begin_anchor:
+        break;
+
+    case end_anchor:
+        accepting = true;
+        break;
+
+    case epsilon:
+    case closure:
+        nullable = accepting = true;
+        break;
+
+    case concatenation:
+    case intersection:
+        nullable = all_of (args.begin (), args.end (), [this](auto n) {
+                return nodes_ [n].nullable;
+            });
+        accepting = all_of (args.begin (), args.end (), [this](auto n) {
+                return nodes_ [n].accepting;
+            });
+        break;
+
+    case alternation:
+        nullable = any_of (args.begin (), args.end (), [this](auto n) {
+                return nodes_ [n].nullable;
+            });
+        accepting = any_of (args.begin (), args.end (), [this](auto n) {
+                return nodes_ [n].accepting;
+            });
+        break;
+
+    case complement:
+        nullable = !nodes_ [args.front ()].nullable;
+        accepting = !nodes_ [args.front ()].accepting;
+        break;
+    }
+
+    //
+    // Holding a ^, which at_begin has to resolve:
+    //
+    const auto anchored = begin_anchor == kind ||
+        any_of (args.begin (), args.end (), [this](auto n) {
+                return nodes_ [n].anchored;
+            });
+
+    node_t node { kind, c, move (args), nullable, accepting, anchored };
+
+    const auto iter = table_.find (node);
+
+    RETA_STATS_UPDATE (
+        ++(iter == table_.end () ? stats.intern_misses : stats.intern_hits));
+
+    if (iter != table_.end ()) {
+        ++hits_;
+        return iter->second;
+    }
+
+    const auto n = nodes_.size ();
+
+    nodes_.push_back (node);
+    table_.emplace (move (node), n);
+
+    return n;
+}
+
+expressions_t::node_type
+expressions_t::make_symbol (int c) {
+    assert (0 <= c && size_t (c) < alphabet_size);
+    return intern (symbol, c, { });
+}
+
+expressions_t::node_type
+expressions_t::make_concatenation (node_type a, node_type b) {
+    if (a == empty_ || b == empty_)
+        return empty_;
+
+    if (a == epsilon_)
+        return b;
+
+    if (b == epsilon_)
+        return a;
+
+    if (nodes_ [a].kind == concatenation) {
+        const auto x = nodes_ [a].args [0], y = nodes_ [a].args [1];
+        return make_concatenation (x, make_concatenation (y, b));
+    }
+
+    return intern (concatenation, 0, { a, b });
+}
+
+expressions_t::node_type
+expressions_t::make_nary (kind_t kind, node_type a, node_type b) {
+    vector< node_type > args;
+
+    for (const auto n : { a, b }) {
+        if (nodes_ [n].kind == kind)
+            args.insert (
+                args.end (), nodes_ [n].args.begin (), nodes_ [n].args.end ());
+        else
+            args.push_back (n);
+    }
+
+    sort (args.begin (), args.end ());
+    args.erase (unique (args.begin (), args.end ()), args.end ());
+
+    //
+    // The empty set is the identity of the alternation and absorbs the
+    // intersection, the universe the other way around:
+    //
+    const auto identity = kind == alternation ? empty_ : universe_;
+    const auto absorbing = kind == alternation ? universe_ : empty_;
+
+    if (binary_search (args.begin (), args.end (), absorbing))
+        return absorbing;
+
+    args.erase (remove (args.begin (), args.end (), identity), args.end ());
+
+    if (args.empty ())
+        return identity;
+
+    if (1 == args.size ())
+        return args.front ();
+
+    return intern (kind, 0, move (args));
+}
+
+expressions_t::node_type
+expressions_t::make_alternation (node_type a, node_type b) {
+    return make_nary (alternation, a, b);
+}
+
+expressions_t::node_type
+expressions_t::make_intersection (node_type a, node_type b) {
+    return make_nary (intersection, a, b);
+}
+
+expressions_t::node_type
+expressions_t::make_closure (node_type a) {
+    if (a == empty_ || a == epsilon_)
+        return epsilon_;
+
+    if (nodes_ [a].kind == closure)
+        return a;
+
+    return intern (closure, 0, { a });
+}
+
+expressions_t::node_type
+expressions_t::make_complement (node_type a) {
+    if (nodes_ [a].kind == complement)
+        return nodes_ [a].args.front ();
+
+    return intern (complement, 0, { a });
+}
+
+expressions_t::node_type
+expressions_t::parse (const string& s) {
+    vector< node_type > st;
+
+    const auto pop = [&]() {
+        assert (!st.empty ());
+
+        const auto n = st.back ();
+        st.pop_back ();
+
+        return n;
+    };
+
+    for (const auto c : s) {
+        assert (0 <= c && c <= (numeric_limits< char >::max) ());
+
+        if ('a' <= c && c <= 'z')
+            st.push_back (make_symbol (c));
+        else if ('^' == c)
+            st.push_back (begin_);
+        else if ('$' == c)
+            st.push_back (end_);
+        else if ('{' == c)
+            throw invalid_argument ("classes need the Thompson construction");
+        else if ('.' == c) {
+            const auto b = pop (), a = pop ();
+            st.push_back (make_concatenation (a, b));
+        }
+        else if ('*' == c)
+            st.push_back (make_closure (pop ()));
+        else if ('|' == c) {
+            const auto b = pop (), a = pop ();
+            st.push_back (make_alternation (a, b));
+        }
+        else
+            assert (0);
+    }
+
+    assert (1 == st.size ());
+    return st.back ();
+}
+
+expressions_t::node_type
+expressions_t::derivative (node_type n, int c) {
+    const auto key = n * alphabet_size + size_t (c);
+
+    {
+        const auto iter = derivatives_.find (key);
+
+        if (iter != derivatives_.end ())
+            return iter->second;
+    }
+
+    //
+    // Copied, interning new nodes invalidates references into the table:
+    //
+    const auto kind = nodes_ [n].kind;
+    const auto args = nodes_ [n].args;
+
+    node_type d = empty_;
+
+    switch (kind) {
+    case empty:
+    case epsilon:
+    case begin_anchor:
+    case end_anchor:
+        break;
+
+    case symbol:
+        if (nodes_ [n].symbol == c)
+            d = epsilon_;
+        break;
+
+    case concatenation:
+        d = make_concatenation (derivative (args [0], c), args [1]);
+
+        if (nodes_ [args [0]].nullable)
+            d = make_alternation (d, derivative (args [1], c));
+        break;
+
+    case alternation:
+    case intersection:
+        d = derivative (args [0], c);
+
+        for (size_t i = 1; i < args.size (); ++i)
+            d = make_nary (kind, d, derivative (args [i], c));
+        break;
+
+    case closure:
+        d = make_concatenation (derivative (args [0], c), n);
+        break;
+
+    case complement:
+        d = make_complement (derivative (args [0], c));
+        break;
+    }
+
+    derivatives_.emplace (key, d);
+
+    return d;
+}
+
+//
+// The ways the expression matches the empty string at the start of the input,
+// as the empty string, $, or the empty set:
+//
+expressions_t::node_type
+expressions_t::empty_width (node_type n) {
+    const auto kind = nodes_ [n].kind;
+    const auto args = nodes_ [n].args;
+
+    const auto of = [this](bool nullable, bool accepting) {
+        return nullable ? epsilon_ : accepting ? end_ : empty_;
+    };
+
+    if (!nodes_ [n].anchored)
+        return of (nodes_ [n].nullable, nodes_ [n].accepting);
+
+    switch (kind) {
+    case concatenation:
+        return make_concatenation (
+            empty_width (args [0]), empty_width (args [1]));
+
+    case alternation:
+    case intersection: {
+        auto d = empty_width (args [0]);
+
+        for (size_t i = 1; i < args.size (); ++i)
+            d = make_nary (kind, d, empty_width (args [i]));
+
+        return d;
+    }
+
+    case complement: {
+        const auto d = empty_width (args [0]);
+        return of (!nodes_ [d].nullable, !nodes_ [d].accepting);
+    }
+
+    default:
+        return epsilon_;
+    }
+}
+
+//
+// ^ holds at the start only: the derivatives drop it, and it is resolved here
+// beforehand, where it is reached without a character before it, in the
+// expressions left over by the empty matches before it:
+//
+expressions_t::node_type
+expressions_t::at_begin (node_type n) {
+    if (!nodes_ [n].anchored)
+        return n;
+
+    const auto kind = nodes_ [n].kind;
+    const auto args = nodes_ [n].args;
+
+    switch (kind) {
+    case concatenation: {
+        auto d = make_concatenation (at_begin (args [0]), args [1]);
+
+        if (nodes_ [args [1]].anchored)
+            d = make_alternation (d, make_concatenation (
+                                      empty_width (args [0]),
+                                      at_begin (args [1])));
+
+        return d;
+    }
+
+    case alternation:
+    case intersection: {
+        auto d = at_begin (args [0]);
+
+        for (size_t i = 1; i < args.size (); ++i)
+            d = make_nary (kind, d, at_begin (args [i]));
+
+        return d;
+    }
+
+    case closure:
+        return make_alternation (
+            epsilon_, make_concatenation (at_begin (args [0]), n));
+
+    case complement:
+        return make_complement (at_begin (args [0]));
+
+    default:
+        return epsilon_;
+    }
+}
+
+void
+expressions_t::symbols (node_type root, vector< bool >& mask) const {
+    vector< bool > visited (nodes_.size ());
+    vector< node_type > st { root };
+
+    while (!st.empty ()) {
+        const auto n = st.back ();
+        st.pop_back ();
+
+        if (visited [n])
+            continue;
+
+        visited [n] = true;
+
+        const auto& node = nodes_ [n];
+
+        if (node.kind == symbol)
+            mask [node.symbol] = true;
+
+        st.insert (st.end (), node.args.begin (), node.args.end ());
+    }
+}
+
+dfa_t
+expressions_t::make_dfa (node_type root) {
+    RETA_STATS_TIMER (make_dfa);
+
+    root = at_begin (root);
+
+    //
+    // All symbols not in the expression have the same derivatives, those of a
+    // representative of them:
+    //
+    vector< bool > mentioned (alphabet_size);
+    symbols (root, mentioned);
+
+    const auto other = int (
+        find (mentioned.begin (), mentioned.end (), false) - mentioned.begin ());
+
+    dfa_t dfa { };
+
+    unordered_map< node_type, size_t > states { { root, 0 } };
+    deque< node_type > queue { root };
+
+    dfa.states.resize (1);
+
+    for (size_t from = 0; !queue.empty (); ++from) {
+        const auto q = queue.front ();
+        queue.pop_front ();
+
+        if (accepting (q))
+            dfa.accept.push_back (from);
+
+        const auto d_other =
+            size_t (other) < alphabet_size ? derivative (q, other) : empty_;
+
+        for (size_t c = 0; c < alphabet_size; ++c) {
+            const auto d = mentioned [c] ? derivative (q, int (c)) : d_other;
+
+            if (d == empty_)
+                continue;
+
+            auto iter = states.find (d);
+
+            if (iter == states.end ()) {
+                iter = states.emplace (d, states.size ()).first;
+
+                dfa.states.emplace_back ();
+                queue.push_back (d);
+            }
+
+            dfa.states [from].emplace_back (int (c), iter->second);
+        }
+    }
+
+    RETA_STATS_UPDATE ({
+            stats.dfa_states += dfa.states.size ();
+
+            for (const auto& ts : dfa.states)
+                stats.dfa_transitions += ts.size ();
+        });
+
+    return dfa;
+}
+
+dfa_t
+make_derivative_dfa (const string& s) {
+    expressions_t expressions;
+    return expressions.make_dfa (expressions.parse (s));
+}
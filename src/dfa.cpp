@@ -1,22 +1,27 @@
 // -*- mode: c++; -*-
 
+#include <cassert>
+
 #include <algorithm>
 #include <iostream>
 #include <iterator>
-#include <map>
 #include <numeric>
-#include <set>
 #include <string>
 #include <vector>
 
 using namespace std;
 
 #include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+#include <reta/util.hpp>
 
-istream& operator>> (istream& ss, dfa_t& a) {
-    ss >> a.start;
-
+template< typename I, typename S >
+istream& operator>> (istream& ss, basic_dfa_t< I, S >& a) {
     size_t n;
+
+    ss >> n;
+    a.start = S (n);
+
     ss >> n;
 
     a.states.resize (n);
@@ -27,21 +32,22 @@ istream& operator>> (istream& ss, dfa_t& a) {
         int from, c, to;
         ss >> from >> c >> to;
 
-        a.states [from].emplace_back (c, to);
+        a.states [from].emplace_back (I (c), S (to));
     }
 
     ss >> n;
 
     for (size_t i = 0, accept; i < n && ss >> accept; ++i)
-        a.accept.emplace_back (accept);
+        a.accept.emplace_back (S (accept));
 
     return ss;
 }
 
-ostream& operator<< (ostream& ss, const dfa_t& a) {
+template< typename I, typename S >
+ostream& operator<< (ostream& ss, const basic_dfa_t< I, S >& a) {
     size_t from = 0;
 
-    ss << "0 " << a.states.size () << ' ' <<
+    ss << size_t (a.start) << ' ' << a.states.size () << ' ' <<
         accumulate (
             a.states.begin (), a.states.end (), 0,
             [](const auto memo, const auto& arg) {
@@ -57,8 +63,8 @@ ostream& operator<< (ostream& ss, const dfa_t& a) {
             });
 
         for (const auto& t : s) {
-            const auto to = t.second;
-            ss << from << ' ' << t.first << ' ' << to << ' ';
+            const auto to = size_t (t.second);
+            ss << from << ' ' << int (t.first) << ' ' << to << ' ';
         }
 
         ++from;
@@ -75,124 +81,455 @@ ostream& operator<< (ostream& ss, const dfa_t& a) {
 
 namespace detail {
 
-struct dfa_state_t {
-    using int_type = int;
-    using size_type = size_t;
+static constexpr size_t npos = size_t (-1);
+
+//
+// The anchors that hold where a closure is taken, ^ before the first byte and
+// $ after the last:
+//
+static constexpr unsigned at_begin = 1, at_end = 2;
+
+static inline bool
+follows (nfa_t::int_type c, unsigned anchors) {
+    return nfa_t::is_epsilon (c) ||
+        ((anchors & at_begin) && nfa_t::begin_anchor == c) ||
+        ((anchors & at_end) && nfa_t::end_anchor == c);
+}
 
-    map< set< size_type >, size_type > closures;
-    map< size_type, vector< pair< int_type, size_type > > > transitions;
-    vector< size_type > accept;
-};
+static size_t
+dfa_hash (const size_t* first, const size_t* last) {
+    size_t h = 0;
+
+    for (; first != last; ++first)
+        h = h * 31 + *first;
+
+    return h * size_t (0x9e3779b97f4a7c15ULL);
+}
+
+//
+// The slot of the table, a power of two in size, that holds the state of the
+// subset, or the empty slot where it goes:
+//
+static size_t
+dfa_probe (
+    const dfa_scratch_t& scratch, size_t h, const size_t* first,
+    const size_t* last) {
+    const auto& table = scratch.table;
+    const auto& offsets = scratch.offsets;
+
+    const auto mask = table.size () - 1;
+
+    for (auto i = (h >> (4 * sizeof h)) & mask;; i = (i + 1) & mask) {
+        const auto j = table [i];
+
+        if (npos == j || (
+                size_t (last - first) == offsets [j + 1] - offsets [j] &&
+                equal (first, last, scratch.arena.begin () + offsets [j])))
+            return i;
+    }
+}
 
 static void
-do_epsilon_closure (const nfa_t& nfa, size_t state, set< size_t >& closure) {
-    for (const auto& t : nfa.states [state]) {
-        const auto c = t.first;
+dfa_rehash (dfa_scratch_t& scratch, size_t n) {
+    auto& table = scratch.table;
+    const auto p = scratch.arena.data ();
 
-        if (c == nfa_t::epsilon) {
-            const auto dst = t.second;
+    table.assign (n, npos);
 
-            const auto iter = closure.find (dst);
+    const auto mask = n - 1;
 
-            if (iter == closure.end ()) {
-                closure.insert (dst);
-                do_epsilon_closure (nfa, dst, closure);
-            }
-        }
+    for (size_t j = 0; j + 1 < scratch.offsets.size (); ++j) {
+        const auto h = dfa_hash (
+            p + scratch.offsets [j], p + scratch.offsets [j + 1]);
+
+        auto i = (h >> (4 * sizeof h)) & mask;
+
+        for (; npos != table [i]; i = (i + 1) & mask) ;
+        table [i] = j;
     }
 }
 
-static set< size_t >
-epsilon_closure (const nfa_t& nfa, size_t n) {
-    set< size_t > closure { n };
-    do_epsilon_closure (nfa, n, closure);
-    return closure;
+//
+// Extends the set, its states marked, with every state reachable over epsilon
+// transitions and over the anchors that hold. Tag transitions are followed as
+// epsilon transitions, the positions they record do not matter to the
+// language:
+//
+static void
+dfa_close (
+    const nfa_t& nfa, dfa_scratch_t& scratch, vector< size_t >& xs,
+    unsigned anchors) {
+    auto& mark = scratch.mark;
+
+    for (size_t i = 0; i < xs.size (); ++i)
+        for (const auto& t : nfa.states [xs [i]])
+            if (follows (t.first, anchors) &&
+                scratch.generation != mark [t.second]) {
+                mark [t.second] = scratch.generation;
+                xs.push_back (t.second);
+            }
 }
 
-static inline bool
-accepting (const nfa_t& nfa, const set< size_t >& c) {
-    const auto& a = nfa.accept;
+//
+// The set accepts if it reaches an accepting state over the anchors that
+// hold:
+//
+static bool
+dfa_accepting (
+    const nfa_t& nfa, dfa_scratch_t& scratch, const vector< size_t >& xs,
+    unsigned anchors) {
+    auto& closure = scratch.closure;
+    const auto generation = ++scratch.generation;
+
+    closure.assign (xs.begin (), xs.end ());
+
+    for (const auto s : closure)
+        scratch.mark [s] = generation;
+
+    dfa_close (nfa, scratch, closure, anchors);
+
+    return any_of (nfa.accept.begin (), nfa.accept.end (), [&](auto s) {
+            return generation == scratch.mark [s];
+        });
+}
 
-    return any_of (c.begin (), c.end (), [&](const auto n) {
-        return a.end () != find (a.begin (), a.end (), n);
-    });
+//
+// Rough cost of a subset held by the construction, in the arena, its offset
+// and its slots in the table, used for the memory budget:
+//
+static inline size_t
+subset_bytes (const vector< size_t >& subset) {
+    return (subset.size () + 3) * sizeof (size_t);
 }
 
 } // namespace detail
 
-dfa_t
-make_dfa (const nfa_t& nfa) {
-    detail::dfa_state_t dfa_state { };
+ostream& operator<< (ostream& ss, dfa_status_t status) {
+    switch (status) {
+    case dfa_status_t::ok:           return ss << "ok";
+    case dfa_status_t::state_limit:  return ss << "state limit";
+    case dfa_status_t::memory_limit: return ss << "memory limit";
+    case dfa_status_t::deadline:     return ss << "deadline";
+    }
 
-    set< set< size_t > > closures { detail::epsilon_closure (nfa, nfa.start) };
-    const auto& initial_closure = *closures.begin ();
+    return ss;
+}
 
-    size_t state_counter = 0;
-    dfa_state.closures.emplace (initial_closure, state_counter);
+dfa_status_t
+make_dfa (
+    const nfa_t& nfa, const dfa_options_t& options, dfa_t& dfa,
+    dfa_scratch_t& scratch) {
+    using namespace detail;
+    using clock_type = dfa_options_t::clock_type;
 
-    if (detail::accepting (nfa, initial_closure))
-        dfa_state.accept.emplace_back (state_counter);
+    RETA_STATS_TIMER (make_dfa);
 
-    ++state_counter;
+    const auto timed = options.deadline != (clock_type::time_point::max) ();
 
-    while (!closures.empty ()) {
-        set< set< size_t > > accum;
+    const auto n = nfa.states.size ();
 
-        for (const auto& closure : closures) {
-            map< int, set< size_t > > transitions;
+    auto& arena = scratch.arena;
+    auto& offsets = scratch.offsets;
+    auto& mark = scratch.mark;
+    auto& subset = scratch.subset;
 
-            const auto from = dfa_state.closures [closure];
+    if (mark.size () < n)
+        mark.resize (n);
 
-            for (const auto state : closure) {
-                for (const auto& t : nfa.states [state]) {
-                    if (nfa_t::epsilon == t.first)
-                        continue;
+    arena.clear ();
+    offsets.assign (1, 0);
+    scratch.table.assign (16, npos);
 
-                    const auto s = detail::epsilon_closure (nfa, t.second);
-                    transitions [t.first].insert (s.begin (), s.end ());
-                }
+    spare_states (dfa.states, scratch.spare);
+
+    dfa.accept.clear ();
+    dfa.start = 0;
+
+    const auto fail = [&](dfa_status_t status) {
+        spare_states (dfa.states, scratch.spare);
+        dfa.accept.clear ();
+
+        return status;
+    };
+
+    //
+    // Unanchored, every subset also holds the closure of the initial state,
+    // as if the expression were preceded by a self-looping state on all bytes,
+    // a match starting anywhere; ^ only holds in the initial state:
+    //
+    auto& restart = scratch.restart;
+
+    if (options.unanchored) {
+        ++scratch.generation;
+
+        restart.assign (1, nfa.start);
+        mark [nfa.start] = scratch.generation;
+
+        dfa_close (nfa, scratch, restart, 0);
+    }
+
+    //
+    // For the earliest match, all the subsets with an accepting state map to
+    // a single accepting sink, which loops on all bytes; its key is not a set
+    // of NFA states. ^ holds in the initial state only, where it may take the
+    // input to acceptance, e.g., $^ on the empty input: a later subset of the
+    // same states accepts without it, and must not share the initial state,
+    // whose key then holds a marker past the states and the sink:
+    //
+    const auto sink = n, marker = n + 1;
+
+    const auto target = [&]() {
+        if (options.earliest && dfa_accepting (nfa, scratch, subset, 0))
+            subset.assign (1, sink);
+    };
+
+    const auto is_sink = [&]() {
+        return 1 == subset.size () && sink == subset.front ();
+    };
+
+    size_t bytes = 0;
+
+    //
+    // The state of the subset at hand, sorted, added if new, or npos past the
+    // bounds:
+    //
+    auto status = dfa_status_t::ok;
+
+    const auto intern = [&](bool initial_accepts) {
+        const auto first = subset.data (), last = first + subset.size ();
+        const auto slot = dfa_probe (
+            scratch, dfa_hash (first, last), first, last);
+
+        const auto found = npos != scratch.table [slot];
+
+        RETA_STATS_UPDATE (
+            ++(found ? stats.intern_hits : stats.intern_misses));
+
+        if (found)
+            return scratch.table [slot];
+
+        const auto to = offsets.size () - 1;
+
+        if (to && to >= options.max_states) {
+            status = dfa_status_t::state_limit;
+            return npos;
+        }
+
+        bytes += subset_bytes (subset);
+
+        RETA_STATS_UPDATE ({
+                stats.closure (subset.size ());
+                stats.bytes (bytes);
+            });
+
+        if (to && bytes > options.max_bytes) {
+            status = dfa_status_t::memory_limit;
+            return npos;
+        }
+
+        arena.insert (arena.end (), first, last);
+        offsets.push_back (arena.size ());
+
+        scratch.table [slot] = to;
+
+        add_states (dfa.states, scratch.spare, 1);
+
+        if (to ? is_sink () || dfa_accepting (nfa, scratch, subset, at_end)
+               : initial_accepts)
+            dfa.accept.push_back (to);
+
+        scratch.next_level.push_back (to);
+
+        if (scratch.table.size () < 2 * offsets.size ())
+            dfa_rehash (scratch, 2 * scratch.table.size ());
+
+        return to;
+    };
+
+    ++scratch.generation;
+
+    subset.assign (1, nfa.start);
+    mark [nfa.start] = scratch.generation;
+
+    dfa_close (nfa, scratch, subset, at_begin);
+    sort (subset.begin (), subset.end ());
+
+    target ();
+
+    const auto initial_accepts = is_sink () || dfa_accepting (
+        nfa, scratch, subset, at_begin | at_end);
+
+    if (!is_sink () && initial_accepts != dfa_accepting (
+            nfa, scratch, subset, at_end))
+        subset.push_back (marker);
+
+    scratch.next_level.clear ();
+    intern (initial_accepts);
+
+    //
+    // Level by level, each in the order of its subsets, sorted, the states
+    // numbered as they are found:
+    //
+    auto& level = scratch.level;
+    auto& moves = scratch.moves;
+
+    const auto before = [&](size_t i, size_t j) {
+        return lexicographical_compare (
+            arena.begin () + offsets [i], arena.begin () + offsets [i + 1],
+            arena.begin () + offsets [j], arena.begin () + offsets [j + 1]);
+    };
+
+    while (!scratch.next_level.empty ()) {
+        level.swap (scratch.next_level);
+        scratch.next_level.clear ();
+
+        sort (level.begin (), level.end (), before);
+
+        for (const auto from : level) {
+            if (timed && clock_type::now () > options.deadline)
+                return fail (dfa_status_t::deadline);
+
+            if (1 == offsets [from + 1] - offsets [from] &&
+                sink == arena [offsets [from]]) {
+                for (int c = 0; c < 256; ++c)
+                    dfa.states [from].emplace_back (c, from);
+
+                bytes += 256 * sizeof (pair< int, size_t >);
+                continue;
             }
 
-            for (const auto& t : transitions) {
-                size_t to = 0;
+            moves.clear ();
 
-                const auto iter = dfa_state.closures.find (t.second);
+            for (auto j = offsets [from]; j < offsets [from + 1]; ++j)
+                if (marker != arena [j])
+                    for (const auto& t : nfa.states [arena [j]])
+                        if (nfa_t::is_symbol (t.first))
+                            moves.push_back (t);
 
-                if (iter == dfa_state.closures.end ()) {
-                    to = state_counter++;
-                    dfa_state.closures.emplace (t.second, to);
+            sort (moves.begin (), moves.end ());
 
-                    if (detail::accepting (nfa, t.second))
-                        dfa_state.accept.emplace_back (to);
+            //
+            // Every byte when unanchored, for the restart, and otherwise the
+            // symbols of the moves:
+            //
+            for (size_t j = 0, c = 0; j < moves.size () ||
+                     (options.unanchored && c < 256); ++c) {
+                if (!options.unanchored)
+                    c = size_t (moves [j].first);
 
-                    accum.insert (t.second);
-                }
-                else {
-                    to = iter->second;
+                ++scratch.generation;
+                subset.clear ();
+
+                for (; j < moves.size () &&
+                         size_t (moves [j].first) == c; ++j) {
+                    const auto s = moves [j].second;
+
+                    if (scratch.generation != mark [s]) {
+                        mark [s] = scratch.generation;
+                        subset.push_back (s);
+                    }
                 }
 
-                dfa_state.transitions [from].emplace_back (t.first, to);
+                if (options.unanchored)
+                    for (const auto s : restart)
+                        if (scratch.generation != mark [s]) {
+                            mark [s] = scratch.generation;
+                            subset.push_back (s);
+                        }
+
+                dfa_close (nfa, scratch, subset, 0);
+                sort (subset.begin (), subset.end ());
+
+                target ();
+
+                const auto to = intern (false);
+
+                if (npos == to)
+                    return fail (status);
+
+                dfa.states [from].emplace_back (int (c), to);
+                bytes += sizeof (pair< int, size_t >);
             }
         }
-
-        closures = accum;
     }
 
-    dfa_t dfa { };
-    dfa.states.resize (state_counter);
+    sort (dfa.accept.begin (), dfa.accept.end ());
 
-    for (auto& t : dfa_state.transitions)
-        dfa.states [t.first] = move (t.second);
+    RETA_STATS_UPDATE ({
+            stats.bytes (bytes);
+            stats.dfa_states += dfa.states.size ();
 
-    for (auto& t : dfa.states)
-        sort (t.begin (), t.end (), [](const auto& lhs, const auto& rhs) {
-                return lhs.first < rhs.first;
-            });
+            for (const auto& ts : dfa.states)
+                stats.dfa_transitions += ts.size ();
+        });
+
+    return dfa_status_t::ok;
+}
+
+dfa_status_t
+make_dfa (const nfa_t& nfa, const dfa_options_t& options, dfa_t& dfa) {
+    dfa_scratch_t scratch;
+    return make_dfa (nfa, options, dfa, scratch);
+}
 
-    dfa.accept = move (dfa_state.accept);
+dfa_t
+make_dfa (const nfa_t& nfa) {
+    dfa_t dfa;
 
-    auto& a = dfa.accept;
-    sort (a.begin (), a.end ());
+    const auto status = make_dfa (nfa, dfa_options_t { }, dfa);
+    assert (dfa_status_t::ok == status);
 
     return dfa;
 }
+
+template< typename I, typename S >
+bool
+match (const basic_dfa_t< I, S >& dfa, const char* first, const char* last) {
+    auto s = dfa.start;
+
+    for (; first != last; ++first) {
+        const auto& ts = dfa.states [s];
+        const auto c = I (size_cast (*first));
+
+        const auto iter = lower_bound (
+            ts.begin (), ts.end (), c, [](const auto& lhs, const auto rhs) {
+                return lhs.first < rhs;
+            });
+
+        if (iter == ts.end () || iter->first != c)
+            return false;
+
+        s = iter->second;
+    }
+
+    const auto& a = dfa.accept;
+    return a.end () != find (a.begin (), a.end (), s);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template bool match (
+    const basic_dfa_t< int, size_t >&, const char*, const char*);
+template istream& operator>> (istream&, basic_dfa_t< int, size_t >&);
+template ostream& operator<< (ostream&, const basic_dfa_t< int, size_t >&);
+
+template bool match (
+    const basic_dfa_t< uint8_t, uint8_t >&, const char*, const char*);
+template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint8_t >&);
+template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint8_t >&);
+
+template bool match (
+    const basic_dfa_t< uint8_t, uint16_t >&, const char*, const char*);
+template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint16_t >&);
+template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint16_t >&);
+
+template bool match (
+    const basic_dfa_t< uint8_t, uint32_t >&, const char*, const char*);
+template istream& operator>> (
+    istream&, basic_dfa_t< uint8_t, uint32_t >&);
+template ostream& operator<< (
+    ostream&, const basic_dfa_t< uint8_t, uint32_t >&);
@@ -26,6 +26,10 @@ dot_graph_t::make_dot (const nfa_t& nfa, const string& name) {
 
             if (0 > t.first)
                 ss << "ϵ";
+            else if (nfa_t::begin_anchor == t.first)
+                ss << '^';
+            else if (nfa_t::end_anchor == t.first)
+                ss << '$';
             else
                 ss << char (t.first);
 
@@ -33,8 +37,9 @@ dot_graph_t::make_dot (const nfa_t& nfa, const string& name) {
         }
     }
 
-    ss << "    q" << nfa.accept.front () << "[shape=doublecircle;rank="
-       << nfa.states.size () << ";];\n";
+    for (const auto state : nfa.accept)
+        ss << "    q" << state << "[shape=doublecircle;rank="
+           << nfa.states.size () << ";];\n";
 
     ss << "}\n";
     ss << "#+END_SRC\n\n";
@@ -0,0 +1,209 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+#include <reta/equivalence.hpp>
+#include <reta/union-find.hpp>
+
+namespace detail {
+
+static inline vector< bool >
+final_states_of (const dfa_t& dfa) {
+    vector< bool > v (dfa.states.size ());
+
+    for (const auto s : dfa.accept)
+        v [s] = true;
+
+    return v;
+}
+
+//
+// Walks the parent links of a breadth-first search back to its root:
+//
+static string
+spell (const vector< pair< size_t, int > >& parents, size_t i) {
+    string s;
+
+    for (; parents [i].first != size_t (-1); i = parents [i].first)
+        s += char (parents [i].second);
+
+    reverse (s.begin (), s.end ());
+
+    return s;
+}
+
+} // namespace detail
+
+bool
+equivalent (const dfa_t& a, const dfa_t& b, string* counterexample) {
+    static const vector< pair< int, size_t > > none;
+
+    //
+    // The states of a, then those of b, then the dead state both share:
+    //
+    const auto na = a.states.size (), nb = b.states.size ();
+    const auto dead = na + nb;
+
+    const auto fa = detail::final_states_of (a);
+    const auto fb = detail::final_states_of (b);
+
+    const auto accepting = [&](size_t s) {
+        return s < na ? fa [s] : s < dead ? fb [s - na] : false;
+    };
+
+    const auto transitions = [&](size_t s) -> const auto& {
+        return s < na ? a.states [s] : s < dead ? b.states [s - na] : none;
+    };
+
+    const auto offset = [&](size_t s, size_t n) {
+        return s == size_t (-1) ? dead : s + n;
+    };
+
+    union_find_t sets (dead + 1);
+
+    //
+    // The pairs to check, a state of a, or the dead state, against one of b,
+    // with the pair and the symbol they were reached from:
+    //
+    vector< pair< size_t, size_t > > queue { { a.start, na + b.start } };
+    vector< pair< size_t, int > > parents { { size_t (-1), 0 } };
+
+    sets.unite (a.start, na + b.start);
+
+    for (size_t i = 0; i < queue.size (); ++i) {
+        const auto p = queue [i].first, q = queue [i].second;
+
+        if (accepting (p) != accepting (q)) {
+            if (counterexample)
+                *counterexample = detail::spell (parents, i);
+
+            return false;
+        }
+
+        const auto& ts = transitions (p);
+        const auto& us = transitions (q);
+
+        auto t = ts.begin (), u = us.begin ();
+
+        while (t != ts.end () || u != us.end ()) {
+            const auto c = (min) (
+                t == ts.end () ? (numeric_limits< int >::max) () : t->first,
+                u == us.end () ? (numeric_limits< int >::max) () : u->first);
+
+            auto x = dead, y = dead;
+
+            if (t != ts.end () && t->first == c)
+                x = offset ((t++)->second, 0);
+
+            if (u != us.end () && u->first == c)
+                y = offset ((u++)->second, na);
+
+            if (sets.unite (x, y)) {
+                queue.emplace_back (x, y);
+                parents.emplace_back (i, c);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+includes (const dfa_t& a, const dfa_t& b, string* counterexample) {
+    static const vector< pair< int, size_t > > none;
+
+    //
+    // The pairs of states of a and b, the missing transitions of either to
+    // its dead state, numbered past its states, are walked breadth-first as
+    // the product of the two would be, without building it; past the dead
+    // state of b, nothing more is accepted by b:
+    //
+    const auto na = a.states.size (), nb = b.states.size ();
+
+    if (0 == nb)
+        return true;
+
+    const auto fa = detail::final_states_of (a);
+    const auto fb = detail::final_states_of (b);
+
+    const auto key = [&](size_t p, size_t q) {
+        return p * (nb + 1) + q;
+    };
+
+    const auto start = na ? a.start : na;
+
+    unordered_set< size_t > seen { key (start, b.start) };
+
+    vector< pair< size_t, size_t > > queue { { start, b.start } };
+    vector< pair< size_t, int > > parents { { size_t (-1), 0 } };
+
+    for (size_t i = 0; i < queue.size (); ++i) {
+        const auto p = queue [i].first, q = queue [i].second;
+
+        if (fb [q] && (p == na || !fa [p])) {
+            if (counterexample)
+                *counterexample = detail::spell (parents, i);
+
+            return false;
+        }
+
+        const auto& ts = p == na ? none : a.states [p];
+        const auto& us = b.states [q];
+
+        auto t = ts.begin ();
+
+        for (const auto& u : us) {
+            while (t != ts.end () && t->first < u.first)
+                ++t;
+
+            const auto x = t != ts.end () && t->first == u.first
+                ? t->second : na;
+
+            if (seen.insert (key (x, u.second)).second) {
+                queue.emplace_back (x, u.second);
+                parents.emplace_back (i, u.first);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+accepts_nothing (const dfa_t& dfa, string* witness) {
+    const auto f = detail::final_states_of (dfa);
+
+    vector< bool > seen (dfa.states.size ());
+    vector< size_t > queue { dfa.start };
+    vector< pair< size_t, int > > parents { { size_t (-1), 0 } };
+
+    seen [dfa.start] = true;
+
+    for (size_t i = 0; i < queue.size (); ++i) {
+        if (f [queue [i]]) {
+            if (witness)
+                *witness = detail::spell (parents, i);
+
+            return false;
+        }
+
+        for (const auto& t : dfa.states [queue [i]]) {
+            if (!seen [t.second]) {
+                seen [t.second] = true;
+
+                queue.push_back (t.second);
+                parents.emplace_back (i, t.first);
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,188 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/stats.hpp>
+
+namespace detail {
+
+//
+// The first and last positions of a subexpression, and whether it matches
+// the empty string:
+//
+struct glushkov_fragment_t {
+    vector< size_t > first, last;
+    bool nullable;
+};
+
+struct glushkov_state_t {
+    nfa_t nfa;
+    vector< int > symbols;
+    vector< glushkov_fragment_t > st;
+};
+
+static inline vector< size_t >
+merge (const vector< size_t >& lhs, const vector< size_t >& rhs) {
+    vector< size_t > v;
+    v.reserve (lhs.size () + rhs.size ());
+
+    set_union (
+        lhs.begin (), lhs.end (), rhs.begin (), rhs.end (),
+        back_inserter (v));
+
+    return v;
+}
+
+//
+// Each position in the first set follows each position in the last set:
+//
+static inline void
+follow (glushkov_state_t& state,
+        const vector< size_t >& from, const vector< size_t >& to) {
+    for (const auto p : from)
+        for (const auto q : to)
+            state.nfa.states [p].emplace_back (state.symbols [q], q);
+}
+
+static void
+glushkov_consume_literal (int c, glushkov_state_t& state) {
+    const auto n = state.nfa.states.size ();
+
+    state.nfa.states.resize (n + 1);
+    state.symbols.push_back (c);
+
+    state.st.push_back ({ { n }, { n }, false });
+}
+
+static void
+glushkov_consume_concatenation (glushkov_state_t& state) {
+    auto& st = state.st;
+    assert (1 < st.size ());
+
+    auto b = move (st.back ()); st.pop_back ();
+    auto a = move (st.back ()); st.pop_back ();
+
+    follow (state, a.last, b.first);
+
+    st.push_back ({
+            a.nullable ? merge (a.first, b.first) : move (a.first),
+            b.nullable ? merge (a.last, b.last) : move (b.last),
+            a.nullable && b.nullable });
+}
+
+static void
+glushkov_consume_kleene_closure (glushkov_state_t& state) {
+    auto& st = state.st;
+    assert (0 < st.size ());
+
+    auto& a = st.back ();
+
+    follow (state, a.last, a.first);
+    a.nullable = true;
+}
+
+static void
+glushkov_consume_alternation (glushkov_state_t& state) {
+    auto& st = state.st;
+    assert (1 < st.size ());
+
+    auto b = move (st.back ()); st.pop_back ();
+    auto a = move (st.back ()); st.pop_back ();
+
+    st.push_back ({
+            merge (a.first, b.first),
+            merge (a.last, b.last),
+            a.nullable || b.nullable });
+}
+
+} // namespace detail
+
+//
+// Position automaton: state 0 is the initial state, state i the i-th literal
+// of the expression, entered on its symbol; there are no epsilon transitions.
+//
+nfa_t
+make_glushkov_nfa (const string& s) {
+    RETA_STATS_TIMER (make_nfa);
+
+    detail::glushkov_state_t state;
+
+    state.nfa.states.resize (1);
+    state.symbols.push_back (nfa_t::epsilon);
+
+    for (const auto c : s) {
+        assert (0 <= c && c <= (numeric_limits< char >::max) ());
+
+        if ('a' <= c && c <= 'z')
+            glushkov_consume_literal (c, state);
+        else if ('^' == c)
+            glushkov_consume_literal (nfa_t::begin_anchor, state);
+        else if ('$' == c)
+            glushkov_consume_literal (nfa_t::end_anchor, state);
+        else if ('{' == c)
+            throw invalid_argument ("classes need the Thompson construction");
+        else if ('.' == c)
+            glushkov_consume_concatenation (state);
+        else if ('*' == c)
+            glushkov_consume_kleene_closure (state);
+        else if ('|' == c)
+            glushkov_consume_alternation (state);
+        else
+            assert (0);
+    }
+
+    assert (1 == state.st.size ());
+    const auto& root = state.st.back ();
+
+    follow (state, { 0 }, root.first);
+
+    auto& nfa = state.nfa;
+
+    for (auto& ts : nfa.states) {
+        sort (ts.begin (), ts.end ());
+        ts.erase (unique (ts.begin (), ts.end ()), ts.end ());
+    }
+
+    nfa.start = 0;
+    nfa.accept = root.last;
+
+    if (root.nullable)
+        nfa.accept.insert (nfa.accept.begin (), 0);
+
+    RETA_STATS_UPDATE ({
+            size_t n = 0;
+
+            for (const auto& ts : nfa.states)
+                n += ts.size ();
+
+            stats.nfa_states += nfa.states.size ();
+            stats.nfa_transitions += n;
+
+            stats.bytes (
+                nfa.states.size () * sizeof (nfa.states [0]) +
+                n * sizeof (nfa.states [0][0]));
+        });
+
+    return nfa;
+}
+
+nfa_t
+make_nfa (const string& s, construction_t construction) {
+    switch (construction) {
+    case construction_t::thompson: return make_nfa (s);
+    case construction_t::glushkov: return make_glushkov_nfa (s);
+    }
+
+    assert (0);
+    return { };
+}
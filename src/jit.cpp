@@ -0,0 +1,258 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+#include <reta/jit.hpp>
+
+#if defined (__x86_64__) && (defined (__linux__) || defined (__APPLE__))
+#  define RETA_JIT_X86_64 1
+#  include <sys/mman.h>
+#endif // __x86_64__
+
+namespace detail {
+
+//
+// States with at least this many transitions, spanning a byte range at most
+// jit_density times their count, dispatch through a jump table instead of a
+// compare chain:
+//
+static constexpr size_t jit_dense_threshold = 4;
+static constexpr size_t jit_density = 4;
+
+struct jit_assembler_t {
+    vector< uint8_t > code;
+
+    //
+    // Labels are the DFA states, followed by the accept and reject exits and
+    // the jump tables of the dense states:
+    //
+    vector< size_t > labels;
+
+    struct fixup_t {
+        size_t offset, label, base;
+        bool relative;
+    };
+
+    vector< fixup_t > fixups;
+
+    explicit jit_assembler_t (size_t n) : labels (n, size_t (-1)) { }
+
+    void bind (size_t label) {
+        labels [label] = code.size ();
+    }
+
+    void emit (initializer_list< uint8_t > bytes) {
+        code.insert (code.end (), bytes);
+    }
+
+    void emit32 (uint32_t value) {
+        for (size_t i = 0; i < 4; ++i, value >>= 8)
+            code.push_back (uint8_t (value));
+    }
+
+    //
+    // A rel32 operand, always the last field of its instruction, i.e., relative
+    // to the address that follows it:
+    //
+    void emit_rel32 (size_t label) {
+        fixups.push_back ({ code.size (), label, 0, true });
+        emit32 (0);
+    }
+
+    //
+    // A jump table entry, relative to the start of its table:
+    //
+    void emit_entry (size_t label, size_t base) {
+        fixups.push_back ({ code.size (), label, base, false });
+        emit32 (0);
+    }
+
+    void align (size_t n) {
+        while (code.size () % n)
+            code.push_back (0xCC);
+    }
+
+    void link () {
+        for (const auto& f : fixups) {
+            assert (labels [f.label] != size_t (-1));
+
+            const auto from = f.relative ? f.offset + 4 : labels [f.base];
+            const auto value = uint32_t (int64_t (labels [f.label]) - int64_t (from));
+
+            for (size_t i = 0; i < 4; ++i)
+                code [f.offset + i] = uint8_t (value >> (8 * i));
+        }
+    }
+};
+
+static inline bool
+jit_dense (const vector< pair< int, size_t > >& ts) {
+    if (ts.size () < jit_dense_threshold)
+        return false;
+
+    const size_t span = ts.back ().first - ts.front ().first + 1;
+    return span <= jit_density * ts.size ();
+}
+
+//
+// Generated code, System V calling convention: rdi is the cursor, rsi the end
+// of the input, the result is returned in eax:
+//
+static vector< uint8_t >
+jit_compile (const dfa_t& dfa, size_t& entry) {
+    const auto n = dfa.states.size ();
+
+    const auto accept_label = n, reject_label = n + 1;
+    size_t table_label = n + 2;
+
+    size_t dense = 0;
+
+    for (const auto& ts : dfa.states)
+        if (jit_dense (ts))
+            ++dense;
+
+    jit_assembler_t a (n + 2 + dense);
+
+    vector< bool > final_state (n);
+
+    for (const auto s : dfa.accept)
+        final_state [s] = true;
+
+    vector< pair< size_t, size_t > > tables;
+
+    for (size_t i = 0; i < n; ++i) {
+        const auto& ts = dfa.states [i];
+
+        a.bind (i);
+
+        a.emit ({ 0x48, 0x39, 0xF7 });       // cmp    rdi, rsi
+        a.emit ({ 0x0F, 0x83 });             // jae    accept/reject
+        a.emit_rel32 (final_state [i] ? accept_label : reject_label);
+
+        if (ts.empty ()) {
+            a.emit ({ 0xE9 });               // jmp    reject
+            a.emit_rel32 (reject_label);
+            continue;
+        }
+
+        a.emit ({ 0x0F, 0xB6, 0x07 });       // movzx  eax, byte [rdi]
+        a.emit ({ 0x48, 0xFF, 0xC7 });       // inc    rdi
+
+        if (jit_dense (ts)) {
+            const uint32_t lo = ts.front ().first, hi = ts.back ().first;
+
+            a.emit ({ 0x2D });               // sub    eax, lo
+            a.emit32 (lo);
+            a.emit ({ 0x3D });               // cmp    eax, hi - lo
+            a.emit32 (hi - lo);
+            a.emit ({ 0x0F, 0x87 });         // ja     reject
+            a.emit_rel32 (reject_label);
+            a.emit ({ 0x48, 0x8D, 0x0D });   // lea    rcx, [rip + table]
+            a.emit_rel32 (table_label);
+            a.emit ({ 0x48, 0x63, 0x14, 0x81 }); // movsxd rdx, dword [rcx + rax * 4]
+            a.emit ({ 0x48, 0x01, 0xCA });   // add    rdx, rcx
+            a.emit ({ 0xFF, 0xE2 });         // jmp    rdx
+
+            tables.emplace_back (i, table_label++);
+        }
+        else {
+            for (const auto& t : ts) {
+                a.emit ({ 0x3D });           // cmp    eax, c
+                a.emit32 (uint32_t (t.first));
+                a.emit ({ 0x0F, 0x84 });     // je     target
+                a.emit_rel32 (t.second);
+            }
+
+            a.emit ({ 0xE9 });               // jmp    reject
+            a.emit_rel32 (reject_label);
+        }
+    }
+
+    a.bind (accept_label);
+    a.emit ({ 0xB8, 0x01, 0x00, 0x00, 0x00 }); // mov    eax, 1
+    a.emit ({ 0xC3 });                       // ret
+
+    a.bind (reject_label);
+    a.emit ({ 0x31, 0xC0 });                 // xor    eax, eax
+    a.emit ({ 0xC3 });                       // ret
+
+    for (const auto& p : tables) {
+        const auto& ts = dfa.states [p.first];
+
+        a.align (4);
+        a.bind (p.second);
+
+        auto iter = ts.begin ();
+
+        for (int c = ts.front ().first; c <= ts.back ().first; ++c) {
+            if (iter != ts.end () && iter->first == c)
+                a.emit_entry ((iter++)->second, p.second);
+            else
+                a.emit_entry (reject_label, p.second);
+        }
+    }
+
+    a.link ();
+
+    entry = a.labels [dfa.start];
+    return move (a.code);
+}
+
+} // namespace detail
+
+jit_t::jit_t (const dfa_t& dfa, bool native)
+    : fun_ (), code_ (), size_ (), table_ (dfa) {
+#if defined (RETA_JIT_X86_64)
+    if (!native || dfa.states.empty ())
+        return;
+
+    for (const auto& ts : dfa.states)
+        for (const auto& t : ts)
+            if (t.first < 0 || 255 < t.first)
+                return;
+
+    size_t entry = 0;
+    const auto code = detail::jit_compile (dfa, entry);
+
+    auto p = mmap (
+        0, code.size (), PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (MAP_FAILED == p)
+        return;
+
+    memcpy (p, code.data (), code.size ());
+
+    if (mprotect (p, code.size (), PROT_READ | PROT_EXEC)) {
+        munmap (p, code.size ());
+        return;
+    }
+
+    code_ = p;
+    size_ = code.size ();
+
+    fun_ = reinterpret_cast< function_type > (
+        reinterpret_cast< char* > (p) + entry);
+#else
+    (void)native;
+#endif // RETA_JIT_X86_64
+}
+
+jit_t::~jit_t () {
+#if defined (RETA_JIT_X86_64)
+    if (code_)
+        munmap (code_, size_);
+#endif // RETA_JIT_X86_64
+}
+
+bool
+match (const jit_t& jit, const char* first, const char* last) {
+    return jit.fun_ ? jit.fun_ (first, last) : match (jit.table_, first, last);
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# -*- mode: python; -*-
+#
+# Writes the code point ranges of the Unicode general categories used by the
+# \p{..} classes, from the character database of the Python unicodedata
+# module:
+#
+#   python3 make-unicode-tables.py > unicode.cpp
+#
+
+import sys
+import unicodedata
+
+CATEGORIES = [
+    ('L', 'letter'), ('Lu', 'uppercase_letter'), ('Ll', 'lowercase_letter'),
+    ('M', 'mark'), ('N', 'number'), ('Nd', 'decimal_number'),
+    ('P', 'punctuation'), ('S', 'symbol'), ('Z', 'separator'),
+]
+
+
+def ranges(name):
+    result = []
+
+    for c in range(0x110000):
+        if not unicodedata.category(chr(c)).startswith(name):
+            continue
+
+        if result and result[-1][1] + 1 == c:
+            result[-1][1] = c
+        else:
+            result.append([c, c])
+
+    return result
+
+
+def main():
+    out = sys.stdout
+
+    out.write('''// -*- mode: c++; -*-
+//
+// Generated by make-unicode-tables.py from the Unicode Character Database
+// %s; do not edit.
+//
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+#include <reta/utf8.hpp>
+
+namespace detail {
+
+using unicode_range_t = pair< uint32_t, uint32_t >;
+''' % unicodedata.unidata_version)
+
+    for name, identifier in CATEGORIES:
+        rs = ranges(name)
+
+        out.write('\n// %s, %d ranges:\n' % (name, len(rs)))
+        out.write('static const unicode_range_t %s [] = {\n' % identifier)
+
+        for i in range(0, len(rs), 3):
+            out.write('   ')
+
+            for lo, hi in rs[i:i + 3]:
+                out.write(' { 0x%x, 0x%x },' % (lo, hi))
+
+            out.write('\n')
+
+        out.write('};\n')
+
+    out.write('''
+struct unicode_property_t {
+    const char* name;
+    const unicode_range_t *first, *last;
+};
+
+static const unicode_property_t unicode_properties [] = {
+''')
+
+    for name, identifier in CATEGORIES:
+        out.write('    { "%s", begin (%s), end (%s) },\n' % (
+            name, identifier, identifier))
+
+    out.write('''};
+
+} // namespace detail
+
+bool
+unicode_property (const string& name, code_point_ranges_t& ranges) {
+    for (const auto& p : detail::unicode_properties) {
+        if (name == p.name) {
+            ranges.assign (p.first, p.last);
+            return true;
+        }
+    }
+
+    return false;
+}
+''')
+
+
+if __name__ == '__main__':
+    main()
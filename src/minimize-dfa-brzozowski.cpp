@@ -0,0 +1,96 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+
+nfa_t
+reverse (const dfa_t& dfa) {
+    const auto n = dfa.states.size ();
+
+    nfa_t nfa { };
+    nfa.states.resize (n + 1);
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& t : dfa.states [i])
+            nfa.states [t.second].emplace_back (t.first, i);
+
+    //
+    // A new initial state, with epsilon transitions to the former accepting
+    // states:
+    //
+    for (const auto s : dfa.accept)
+        nfa.states [n].emplace_back (nfa_t::epsilon, s);
+
+    nfa.start = n;
+    nfa.accept.push_back (dfa.start);
+
+    return nfa;
+}
+
+//
+// The subset of the initial state of the determinized reverse holds the new
+// initial state, which has no incoming transitions; the same subset without
+// it may also be reached, as a state that has the same transitions and
+// acceptance. The initial state is then folded into that one:
+//
+static dfa_t
+fold_start (dfa_t dfa) {
+    const auto n = dfa.states.size ();
+    const auto s = dfa.start;
+
+    const auto accepting = [&](size_t i) {
+        return binary_search (dfa.accept.begin (), dfa.accept.end (), i);
+    };
+
+    size_t twin = 0;
+
+    for (; twin < n; ++twin)
+        if (twin != s &&
+            dfa.states [twin] == dfa.states [s] &&
+            accepting (twin) == accepting (s))
+            break;
+
+    if (twin == n)
+        return dfa;
+
+    const auto renumber = [s](size_t i) { return i > s ? i - 1 : i; };
+
+    dfa.states.erase (dfa.states.begin () + s);
+
+    for (auto& ts : dfa.states)
+        for (auto& t : ts) {
+            assert (t.second != s);
+            t.second = renumber (t.second);
+        }
+
+    dfa.accept.erase (
+        remove (dfa.accept.begin (), dfa.accept.end (), s), dfa.accept.end ());
+
+    for (auto& a : dfa.accept)
+        a = renumber (a);
+
+    dfa.start = renumber (twin);
+
+    return dfa;
+}
+
+//
+// Determinizing the reverse of an automaton which has only reachable states
+// yields a minimal automaton of the reverse language; doing it twice yields
+// the minimal automaton of the language:
+//
+dfa_t
+minimize_dfa_brzozowski (const dfa_t& src) {
+    RETA_STATS_TIMER (minimize);
+
+    const auto dfa = fold_start (make_dfa (reverse (src)));
+    return fold_start (make_dfa (reverse (dfa)));
+}
@@ -0,0 +1,289 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+#include <reta/util.hpp>
+
+namespace detail {
+
+//
+// Refinable partition of the states, over the buffers of the scratch: the
+// states of a block are contiguous in elems, the marked ones at the front of
+// the block, up to mid.
+//
+struct partition_t {
+    partition_t (minimize_scratch_t& scratch, size_t n)
+        : elems (scratch.elems), loc (scratch.loc), block (scratch.block),
+          first (scratch.first), mid (scratch.mid), end (scratch.end),
+          touched (scratch.touched) {
+        elems.resize (n);
+        loc.resize (n);
+        block.assign (n, 0);
+
+        for (size_t i = 0; i < n; ++i)
+            elems [i] = loc [i] = i;
+
+        first.assign (1, 0);
+        mid.assign (1, 0);
+        end.assign (1, n);
+
+        touched.clear ();
+    }
+
+    size_t size () const {
+        return first.size ();
+    }
+
+    void mark (size_t s) {
+        const auto b = block [s];
+        const auto i = loc [s], j = mid [b];
+
+        if (i < j)
+            return;
+
+        swap (elems [i], elems [j]);
+
+        loc [elems [i]] = i;
+        loc [elems [j]] = j;
+
+        if (mid [b]++ == first [b])
+            touched.push_back (b);
+    }
+
+    //
+    // Splits off the marked states of the block into a new block, unless all
+    // or none are marked; returns the new block or size_t (-1):
+    //
+    size_t split (size_t b) {
+        if (mid [b] == end [b]) {
+            mid [b] = first [b];
+            return size_t (-1);
+        }
+
+        const auto nb = first.size ();
+
+        first.push_back (first [b]);
+        mid.push_back (first [b]);
+        end.push_back (mid [b]);
+
+        first [b] = mid [b];
+
+        for (auto i = first [nb]; i < end [nb]; ++i)
+            block [elems [i]] = nb;
+
+        return nb;
+    }
+
+    vector< size_t > &elems, &loc, &block;
+    vector< size_t > &first, &mid, &end;
+    vector< size_t >& touched;
+};
+
+} // namespace detail
+
+void
+minimize_dfa_hopcroft (
+    const dfa_t& src, dfa_t& dst, minimize_scratch_t& scratch) {
+    RETA_STATS_TIMER (minimize);
+
+    //
+    // Completed with a dead state, n, over the symbols of the automaton:
+    //
+    const auto n = src.states.size ();
+
+    auto& symbols = scratch.symbols;
+    symbols.clear ();
+
+    for (const auto& ts : src.states)
+        for (const auto& t : ts)
+            symbols.push_back (t.first);
+
+    sort (symbols.begin (), symbols.end ());
+    symbols.erase (unique (symbols.begin (), symbols.end ()), symbols.end ());
+
+    const auto k = symbols.size ();
+
+    const auto index_of = [&](int c) {
+        return size_t (
+            lower_bound (symbols.begin (), symbols.end (), c) - symbols.begin ());
+    };
+
+    auto& delta = scratch.delta;
+    delta.assign ((n + 1) * k, n);
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& t : src.states [i])
+            delta [i * k + index_of (t.first)] = t.second;
+
+    //
+    // Inverse transitions, per symbol and target:
+    //
+    auto& offsets = scratch.offsets;
+    auto& sources = scratch.sources;
+
+    offsets.assign ((n + 1) * k + 1, 0);
+    sources.resize ((n + 1) * k);
+
+    for (size_t s = 0; s <= n; ++s)
+        for (size_t a = 0; a < k; ++a)
+            ++offsets [a * (n + 1) + delta [s * k + a] + 1];
+
+    for (size_t i = 1; i < offsets.size (); ++i)
+        offsets [i] += offsets [i - 1];
+
+    {
+        auto& pos = scratch.positions;
+        pos.assign (offsets.begin (), offsets.end ());
+
+        for (size_t s = 0; s <= n; ++s)
+            for (size_t a = 0; a < k; ++a)
+                sources [pos [a * (n + 1) + delta [s * k + a]]++] = s;
+    }
+
+    detail::partition_t p (scratch, n + 1);
+
+    for (const auto s : src.accept)
+        p.mark (s);
+
+    p.touched.clear ();
+
+    //
+    // The worklist is first in, first out, from head; pending flags the
+    // (block, symbol) pairs on it, k to a block:
+    //
+    auto& worklist = scratch.worklist;
+    auto& pending = scratch.pending;
+
+    worklist.clear ();
+    pending.clear ();
+
+    const auto is_pending = [&](size_t b, size_t a) {
+        return b * k + a < pending.size () && pending [b * k + a];
+    };
+
+    const auto push = [&](size_t b, size_t a) {
+        if (pending.size () <= b * k + a)
+            pending.resize ((b + 1) * k);
+
+        if (!pending [b * k + a]) {
+            pending [b * k + a] = true;
+            worklist.emplace_back (b, a);
+        }
+    };
+
+    if (!src.accept.empty () && size_t (-1) != p.split (0))
+        for (size_t a = 0; a < k; ++a)
+            push (1, a);
+
+    auto& splitter = scratch.splitter;
+    auto& splitting = scratch.splitting;
+
+    for (size_t head = 0; head < worklist.size (); ++head) {
+        size_t b, a;
+        tie (b, a) = worklist [head];
+
+        pending [b * k + a] = false;
+
+        //
+        // Collected first, marking moves states around within their blocks,
+        // b included:
+        //
+        splitter.clear ();
+
+        for (auto i = p.first [b]; i < p.end [b]; ++i) {
+            const auto c = a * (n + 1) + p.elems [i];
+
+            splitter.insert (
+                splitter.end (),
+                sources.begin () + offsets [c], sources.begin () + offsets [c + 1]);
+        }
+
+        for (const auto s : splitter)
+            p.mark (s);
+
+        splitting.swap (p.touched);
+        p.touched.clear ();
+
+        for (const auto y : splitting) {
+            const auto z = p.split (y);
+
+            if (size_t (-1) == z)
+                continue;
+
+            const auto smaller =
+                p.end [z] - p.first [z] < p.end [y] - p.first [y] ? z : y;
+
+            for (size_t c = 0; c < k; ++c)
+                push (is_pending (y, c) ? z : smaller, c);
+        }
+    }
+
+    //
+    // Blocks numbered breadth-first from the start, the block of the dead
+    // state left out:
+    //
+    const auto dead = p.block [n];
+
+    auto& number = scratch.number;
+    auto& queue = scratch.queue;
+
+    number.assign (p.size (), size_t (-1));
+    queue.assign (1, p.block [src.start]);
+
+    number [queue.front ()] = 0;
+
+    spare_states (dst.states, scratch.spare);
+    dst.accept.clear ();
+
+    for (size_t i = 0; i < queue.size (); ++i) {
+        const auto b = queue [i];
+        const auto s = p.elems [p.first [b]];
+
+        add_states (dst.states, scratch.spare, 1);
+
+        for (size_t a = 0; a < k; ++a) {
+            const auto to = p.block [delta [s * k + a]];
+
+            if (to == dead)
+                continue;
+
+            if (size_t (-1) == number [to]) {
+                number [to] = queue.size ();
+                queue.push_back (to);
+            }
+
+            dst.states [i].emplace_back (symbols [a], number [to]);
+        }
+    }
+
+    for (const auto s : src.accept) {
+        const auto b = p.block [s];
+
+        if (size_t (-1) != number [b])
+            dst.accept.push_back (number [b]);
+    }
+
+    sort (dst.accept.begin (), dst.accept.end ());
+    dst.accept.erase (
+        unique (dst.accept.begin (), dst.accept.end ()), dst.accept.end ());
+
+    dst.start = 0;
+}
+
+dfa_t
+minimize_dfa_hopcroft (const dfa_t& src) {
+    minimize_scratch_t scratch;
+
+    dfa_t dst;
+    minimize_dfa_hopcroft (src, dst, scratch);
+
+    return dst;
+}
@@ -1,16 +1,18 @@
 // -*- mode: c++; -*-
 
 #include <cassert>
+#include <climits>
 
 #include <algorithm>
-#include <map>
-#include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 using namespace std;
 
 #include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+#include <reta/union-find.hpp>
 
 static inline bool
 distinct (vector< vector< bool > >& t, size_t i, size_t j) {
@@ -45,6 +47,16 @@ final_states_of (const dfa_t& dfa) {
     return v;
 }
 
+template< typename T >
+inline T unique_sorted (T arg) {
+    sort (arg.begin (), arg.end ());
+
+    auto last = unique (arg.begin (), arg.end ());
+    arg.resize (distance (arg.begin (), last));
+
+    return arg;
+}
+
 static vector< vector< bool > >
 make_minimization_table (const dfa_t& dfa) {
     const auto n = dfa.states.size ();
@@ -59,22 +71,35 @@ make_minimization_table (const dfa_t& dfa) {
     assert (t.front ().size () == n - 1);
     assert (t.back  ().size () == 1);
 
+    RETA_STATS_UPDATE (
+        stats.bytes (n * sizeof (t [0]) + n * (n - 1) / 2 / CHAR_BIT));
+
     const auto f = final_states_of (dfa);
 
     for (size_t i = 0; i < n - 1; ++i)
         for (size_t j = i + 1; j < n; ++j)
             t [i][j - i - 1] = f [i] ^ f [j];
 
+    vector< int > symbols;
+
+    for (const auto& ts : dfa.states)
+        for (const auto& p : ts)
+            symbols.push_back (p.first);
+
+    symbols = unique_sorted (symbols);
+
     for (bool changed = true; changed; ) {
         changed = false;
 
+        RETA_STATS_UPDATE (++stats.minimization_sweeps);
+
         for (size_t i = 0; i < n - 1; ++i) {
             for (size_t j = i + 1; j < n; ++j) {
 
                 if (t [i][j - i - 1])
                     continue;
 
-                for (int c = 'a'; c <= 'z'; ++c)
+                for (const auto c : symbols)
                     if (distinct (dfa, i, j, c, t))
                         t [i][j - i - 1] = changed = true;
             }
@@ -84,49 +109,27 @@ make_minimization_table (const dfa_t& dfa) {
     return t;
 }
 
-static inline vector< size_t >
-flatten (const vector< vector< size_t > >& v) {
-    vector< size_t > u;
-
-    for (const auto& w : v)
-        u.insert (u.end (), w.begin (), w.end ());
-
-    return u;
-}
-
-template< typename T >
-inline T unique_sorted (T arg) {
-    sort (arg.begin (), arg.end ());
-
-    auto last = unique (arg.begin (), arg.end ());
-    arg.resize (distance (arg.begin (), last));
-
-    return arg;
-}
-
 static vector< size_t >
 distinguishable_states (
     const dfa_t& dfa, const vector< vector< size_t > >& indistinct) {
-    const auto n = dfa.states.size ();
-
-    auto lhs = vector< size_t > ();
-    lhs.reserve (n);
-
-    size_t g = 0;
-    generate_n (back_inserter (lhs), n, [g]() mutable { return g++; });
+    vector< bool > covered (dfa.states.size ());
 
-    auto rhs = unique_sorted (flatten (indistinct));
+    for (const auto& v : indistinct)
+        for (const auto s : v)
+            covered [s] = true;
 
     vector< size_t > diff;
 
-    set_difference (
-        lhs.begin (), lhs.end (),
-        rhs.begin (), rhs.end (),
-        back_inserter (diff));
+    for (size_t i = 0; i < covered.size (); ++i)
+        if (!covered [i])
+            diff.push_back (i);
 
     return diff;
 }
 
+//
+// Pairs come out in lexicographic order:
+//
 static vector< tuple< size_t, size_t > >
 indistinguishable_states (const vector< vector< bool > >& t) {
     const auto n = t.size () + 1;
@@ -141,220 +144,141 @@ indistinguishable_states (const vector< vector< bool > >& t) {
         }
     }
 
-    static const auto pair_less = [](const auto& lhs, const auto& rhs) {
-        return
-            (get< 0 > (lhs)  < get< 0 > (rhs)) ||
-            (get< 0 > (lhs) == get< 0 > (rhs)  && get< 1 > (lhs) < get< 1 > (rhs));
-    };
-
-    sort (v.begin (), v.end (), pair_less);
-
     return v;
 }
 
 ////////////////////////////////////////////////////////////////////////
 
-static vector< int >
-make_color_table (const vector< tuple< size_t, size_t > >& v) {
-    vector< int > u;
-
-    for (const auto& t : v) {
-        size_t a, b;
-        tie (a, b) = t;
-
-        const auto c = (max) (a, b);
-
-        if (size_t (c) >= u.size ())
-            u.resize (c + 1, -1);
-
-        u [a] = u [b] = 0;
-    }
+//
+// Equivalence classes of the indistinguishable pairs. A class is labeled
+// with the earliest label of the classes merged into it, a new one for each
+// pair of states not seen before; the states up to the largest one in a pair,
+// which are in none, follow as singletons:
+//
+static vector< vector< size_t > >
+cluster (const vector< tuple< size_t, size_t > >& v) {
+    size_t n = 0;
 
-    return u;
-}
+    for (const auto& p : v)
+        n = (max) (n, (max) (get< 0 > (p), get< 1 > (p)) + 1);
 
-static inline void
-recolor (vector< int >& v, int from, int to) {
-    if (from == to)
-        return;
+    union_find_t sets (n);
 
-    for (auto& c : v)
-        if (c == from) c = to;
-}
+    vector< bool > seen (n);
+    vector< size_t > label (n);
 
-static vector< vector< size_t > >
-cluster (const vector< tuple< size_t, size_t > >& v) {
     size_t counter = 0;
 
-    auto u = make_color_table (v);
-
-    for (auto& p : v) {
+    for (const auto& p : v) {
         size_t a, b;
         tie (a, b) = p;
 
-        const unsigned mask = (u [a] ? 2: 0) | (u [b] ? 1 : 0);
-
-        switch (mask) {
-        case 0:
-            u [a] = u [b] = ++counter;
-            break;
+        const auto x = sets.find (a), y = sets.find (b);
 
-        case 1:
-            u [a] = u [b];
-            break;
+        size_t c;
 
-        case 2:
-            u [b] = u [a];
-            break;
+        if (!seen [a] && !seen [b])
+            c = ++counter;
+        else if (!seen [a])
+            c = label [y];
+        else if (!seen [b])
+            c = label [x];
+        else
+            c = (min) (label [x], label [y]);
 
-        case 3: {
-            auto lhs = u [a], rhs = u [b];
-
-            if (lhs != rhs) {
-                if (lhs > rhs)
-                    swap (lhs, rhs);
-
-                recolor (u, rhs, lhs);
-            }
-        }
-            break;
+        seen [a] = seen [b] = true;
 
-        default:
-            assert (0);
-            break;
-        }
+        sets.unite (x, y);
+        label [sets.find (x)] = c;
     }
 
-    for (auto& c : u)
-        if (0 > c) c = ++counter;
+    vector< size_t > keys (n);
+
+    for (size_t i = 0; i < n; ++i)
+        keys [i] = seen [i] ? label [sets.find (i)] : ++counter;
 
-    map< size_t, vector< size_t > > m;
+    vector< vector< size_t > > buckets (counter + 1);
 
-    for (size_t i = 0; i < u.size (); ++i)
-        m [u [i]].emplace_back (i);
+    for (size_t i = 0; i < n; ++i)
+        buckets [keys [i]].push_back (i);
 
     vector< vector< size_t > > w;
 
-    for (auto& p : m)
-        w.emplace_back (move (p.second));
+    for (auto& b : buckets)
+        if (!b.empty ())
+            w.emplace_back (move (b));
 
     return w;
 }
 
-static inline vector< int >
-collect_input (const dfa_t& dfa, const vector< size_t >& states) {
-    vector< int > v;
-
-    for (const auto s : states)
-        for (const auto& p : dfa.states [s])
-            v.emplace_back (p.first);
-
-    return unique_sorted (v);
-}
-
-static map< size_t, size_t >
+//
+// Numbers the classes in order, then the remaining states:
+//
+static vector< size_t >
 make_state_map (
+    size_t n,
     const vector< vector< size_t > >& a,
     const vector< size_t >& b) {
 
-    map< size_t, size_t > m;
+    vector< size_t > m (n, size_t (-1));
 
     size_t i = 0;
 
     for (const auto& v : a) {
         for (const auto u : v)
-            m.emplace (u, i);
+            m [u] = i;
 
         ++i;
     }
 
     for (const auto q : b)
-        m.emplace (q, i++);
+        m [q] = i++;
 
     return m;
 }
 
-static inline vector< size_t >
-collect_output_states (
-    const dfa_t& src, const vector< size_t >& states, int i) {
-
-    vector< size_t > v;
-
-    for (const auto s : states)
-        for (const auto& p : src.states [s])
-            if (i == p.first)
-                v.push_back (p.second);
-
-    return unique_sorted (v);
-}
-
-static size_t
-map_source_state (
-    const vector< size_t >& states, const map< size_t, size_t >& m) {
-
-    vector< size_t > v;
-    v.reserve (states.size ());
-
-    for (const auto s : states) {
-        const auto iter = m.find (s);
-        assert (iter != m.end ());
-
-        v.push_back (iter->second);
-    }
-
-    v = unique_sorted (v);
-    assert (1 == v.size ()); // TODO
-
-    return v [0];
-}
-
-static size_t
-map_destination_state (
-    const vector< size_t >& states, const map< size_t, size_t >& m) {
-
-    vector< size_t > v;
-
-    for (const auto s : states) {
-        const auto iter = m.find (s);
-        assert (iter != m.end ());
-
-        v.push_back (iter->second);
-    }
-
-    v = unique_sorted (v);
-    assert (1 == v.size ());
-
-    return v [0];
-}
-
 static inline dfa_t
 make_minimal_dfa (
     const dfa_t& src,
     const vector< vector< size_t > >& indistinct,
     const vector< size_t >& distinct) {
 
-    map< size_t, size_t > m = make_state_map (indistinct, distinct);
+    const auto m = make_state_map (src.states.size (), indistinct, distinct);
 
     dfa_t dst { };
     dst.states.resize (indistinct.size () + distinct.size ());
 
+    //
+    // The transitions of a class are those of all its states, which agree on
+    // the class of the destination for every symbol they have in common:
+    //
+    vector< pair< int, size_t > > ts;
+
     for (const auto& states : indistinct) {
-        const auto from = map_source_state (states, m);
+        const auto from = m [states.front ()];
+
+        ts.clear ();
 
-        for (const auto i : collect_input (src, states)) {
-            const auto to = map_destination_state (
-                collect_output_states (src, states, i), m);
-            dst.states [from].emplace_back (i, to);
+        for (const auto s : states) {
+            assert (m [s] == from);
+
+            for (const auto& p : src.states [s])
+                ts.emplace_back (p.first, m [p.second]);
+        }
+
+        ts = unique_sorted (ts);
+
+        for (size_t i = 0; i < ts.size (); ++i) {
+            assert (0 == i || ts [i - 1].first != ts [i].first);
+            dst.states [from].push_back (ts [i]);
         }
     }
 
     for (const auto s : distinct) {
         const auto from = m [s];
 
-        for (const auto& p : src.states [s]) {
-            const auto to = m [p.second];
-            dst.states [from].emplace_back (p.first, to);
-        }
+        for (const auto& p : src.states [s])
+            dst.states [from].emplace_back (p.first, m [p.second]);
     }
 
     for (const auto s : src.accept)
@@ -370,7 +294,14 @@ make_minimal_dfa (
 ////////////////////////////////////////////////////////////////////////
 
 dfa_t
-minimize_dfa_table (const dfa_t& src) {
+minimize_dfa_table (const dfa_t& arg) {
+    RETA_STATS_TIMER (minimize);
+
+    //
+    // The table is quadratic in the states, useless ones are dropped first:
+    //
+    const auto src = trim (arg);
+
     if (src.states.size () < 2)
         return src;
 
@@ -0,0 +1,62 @@
+// -*- mode: c++; -*-
+
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+
+//
+// From the BM_minimize benchmarks: Hopcroft is ahead of the table minimizer
+// everywhere past a couple of states, by two orders of magnitude on a couple
+// of thousands. Brzozowski is ahead of Hopcroft only on small acyclic automata,
+// e.g., unions of a few literals, where the reverse determinizes into few
+// states; it falls behind quickly on cyclic ones:
+//
+static constexpr size_t brzozowski_max_states = 64;
+
+static bool
+acyclic (const dfa_t& dfa) {
+    enum { white, grey, black };
+
+    vector< int > color (dfa.states.size (), white);
+    vector< pair< size_t, size_t > > st { { dfa.start, 0 } };
+
+    color [dfa.start] = grey;
+
+    while (!st.empty ()) {
+        auto& top = st.back ();
+        const auto& ts = dfa.states [top.first];
+
+        if (top.second == ts.size ()) {
+            color [top.first] = black;
+            st.pop_back ();
+            continue;
+        }
+
+        const auto to = ts [top.second++].second;
+
+        if (grey == color [to])
+            return false;
+
+        if (white == color [to]) {
+            color [to] = grey;
+            st.emplace_back (to, 0);
+        }
+    }
+
+    return true;
+}
+
+dfa_t
+minimize_dfa (const dfa_t& arg) {
+    const auto src = trim (arg);
+
+    if (src.states.size () < 2)
+        return minimize_dfa_table (src);
+
+    if (src.states.size () <= brzozowski_max_states && acyclic (src))
+        return minimize_dfa_brzozowski (src);
+
+    return minimize_dfa_hopcroft (src);
+}
@@ -7,23 +7,25 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <numeric>
-#include <stack>
+#include <tuple>
 #include <vector>
 
 using namespace std;
 
 #include <reta/nfa.hpp>
+#include <reta/stats.hpp>
+#include <reta/utf8.hpp>
 #include <reta/util.hpp>
 
-/* static */ constexpr nfa_t::int_type nfa_t::epsilon /* = -1 */;
-
-////////////////////////////////////////////////////////////////////////
+template< typename I, typename S >
+istream& operator>> (istream& ss, basic_nfa_t< I, S >& a) {
+    size_t n;
 
-istream& operator>> (istream& ss, nfa_t& a) {
-    ss >> a.start;
+    ss >> n;
+    a.start = S (n);
 
-    size_t n;
     ss >> n;
 
     a.states.resize (n);
@@ -34,21 +36,22 @@ istream& operator>> (istream& ss, nfa_t& a) {
         int from, c, to;
         ss >> from >> c >> to;
 
-        a.states [from].emplace_back (c, to);
+        a.states [from].emplace_back (I (c), S (to));
     }
 
     ss >> n;
 
     for (size_t i = 0, accept; i < n && ss >> accept; ++i)
-        a.accept.emplace_back (accept);
+        a.accept.emplace_back (S (accept));
 
     return ss;
 }
 
-ostream& operator<< (ostream& ss, const nfa_t& a) {
+template< typename I, typename S >
+ostream& operator<< (ostream& ss, const basic_nfa_t< I, S >& a) {
     size_t from = 0;
 
-    ss << "0 " << a.states.size () << ' ' <<
+    ss << size_t (a.start) << ' ' << a.states.size () << ' ' <<
         accumulate (
             a.states.begin (), a.states.end (), 0,
             [](const auto memo, const auto& arg) {
@@ -64,8 +67,8 @@ ostream& operator<< (ostream& ss, const nfa_t& a) {
             });
 
         for (const auto& t : s) {
-            const auto to = t.second;
-            ss << from << ' ' << t.first << ' ' << to << ' ';
+            const auto to = size_t (t.second);
+            ss << from << ' ' << int (t.first) << ' ' << to << ' ';
         }
 
         ++from;
@@ -84,24 +87,92 @@ ostream& operator<< (ostream& ss, const nfa_t& a) {
 
 namespace detail {
 
+//
+// The states come from the spare ones, transitions cleared, when there are
+// any, so that a compilation into the same automaton reuses their storage:
+//
 struct nfa_state_t {
-    nfa_t nfa;
-    stack< size_t > st;
+    nfa_t& nfa;
+    vector< size_t >& st;
+    vector< vector< pair< int, size_t > > >& spare;
 };
 
+static void
+nfa_add_states (nfa_state_t& state, size_t n) {
+    add_states (state.nfa.states, state.spare, n);
+}
+
+static size_t
+nfa_pop (nfa_state_t& state) {
+    const auto s = state.st.back ();
+    state.st.pop_back ();
+    return s;
+}
+
 static void
 nfa_consume_literal (int c, nfa_state_t& state) {
     auto& nfa = state.nfa;
 
     const auto n = nfa.states.size ();
 
-    nfa.states.resize (n + 2);
+    nfa_add_states (state, 2);
     nfa.states [n].emplace_back (c, n + 1);
 
     auto& st = state.st;
 
-    st.push (n);
-    st.push (n + 1);
+    st.push_back (n);
+    st.push_back (n + 1);
+}
+
+//
+// A class is an alternation of the UTF-8 sequences of its ranges, from one
+// state: the bytes of a sequence but the first lead to a state per byte range
+// and next state, shared by all the sequences that end the same, so that
+// their continuation bytes are not repeated for every lead byte.
+//
+static void
+nfa_consume_class (const code_point_ranges_t& ranges, nfa_state_t& state) {
+    auto& nfa = state.nfa;
+
+    const auto n = nfa.states.size ();
+    nfa_add_states (state, 2);
+
+    map< tuple< uint8_t, uint8_t, size_t >, size_t > suffixes;
+
+    const auto add = [&](size_t from, pair< uint8_t, uint8_t > r, size_t to) {
+        for (int c = r.first; c <= r.second; ++c)
+            nfa.states [from].emplace_back (c, to);
+    };
+
+    for (const auto& r : ranges) {
+        for (const auto& seq : utf8_sequences (r.first, r.second)) {
+            size_t next = n + 1;
+
+            for (size_t i = seq.size () - 1; i > 0; --i) {
+                const auto key = make_tuple (
+                    seq [i].first, seq [i].second, next);
+
+                auto iter = suffixes.find (key);
+
+                if (iter == suffixes.end ()) {
+                    const auto m = nfa.states.size ();
+                    nfa_add_states (state, 1);
+
+                    add (m, seq [i], next);
+                    iter = suffixes.emplace (key, m).first;
+                }
+
+                next = iter->second;
+            }
+
+            add (n, seq [0], next);
+        }
+    }
+
+    auto& st = state.st;
+
+    st.push_back (n);
+    st.push_back (n + 1);
 }
 
 static void
@@ -109,30 +180,27 @@ nfa_consume_concatenation (nfa_state_t& state) {
     auto& st = state.st;
     assert (3 < st.size ());
 
-    const size_t d = st.top (); st.pop ();
-    const size_t c = st.top (); st.pop ();
-    const size_t b = st.top (); st.pop ();
-    const size_t a = st.top (); st.pop ();
+    const auto d = nfa_pop (state), c = nfa_pop (state);
+    const auto b = nfa_pop (state), a = nfa_pop (state);
 
     auto& nfa = state.nfa;
     nfa.states [b].emplace_back (nfa_t::epsilon, c);
 
-    st.push (a);
-    st.push (d);
+    st.push_back (a);
+    st.push_back (d);
 }
 
 static void
 nfa_consume_kleene_closure (nfa_state_t& state) {
     auto& nfa = state.nfa;
 
-    const auto n = state.nfa.states.size ();
-    nfa.states.resize (n + 2);
+    const auto n = nfa.states.size ();
+    nfa_add_states (state, 2);
 
     auto& st = state.st;
     assert (1 < st.size ());
 
-    const size_t b = st.top (); st.pop ();
-    const size_t a = st.top (); st.pop ();
+    const auto b = nfa_pop (state), a = nfa_pop (state);
 
     auto& states = nfa.states;
 
@@ -142,24 +210,22 @@ nfa_consume_kleene_closure (nfa_state_t& state) {
     states [b].emplace_back (nfa_t::epsilon, a);
     states [b].emplace_back (nfa_t::epsilon, n + 1);
 
-    st.push (n);
-    st.push (n + 1);
+    st.push_back (n);
+    st.push_back (n + 1);
 }
 
 static void
 nfa_consume_alternation (nfa_state_t& state) {
     auto& nfa = state.nfa;
 
-    const auto n = state.nfa.states.size ();
-    nfa.states.resize (n + 2);
+    const auto n = nfa.states.size ();
+    nfa_add_states (state, 2);
 
     auto& st = state.st;
     assert (3 < st.size ());
 
-    const size_t d = st.top (); st.pop ();
-    const size_t c = st.top (); st.pop ();
-    const size_t b = st.top (); st.pop ();
-    const size_t a = st.top (); st.pop ();
+    const auto d = nfa_pop (state), c = nfa_pop (state);
+    const auto b = nfa_pop (state), a = nfa_pop (state);
 
     nfa.states [n].emplace_back (nfa_t::epsilon, a);
     nfa.states [n].emplace_back (nfa_t::epsilon, c);
@@ -167,21 +233,43 @@ nfa_consume_alternation (nfa_state_t& state) {
     nfa.states [b].emplace_back (nfa_t::epsilon, n + 1);
     nfa.states [d].emplace_back (nfa_t::epsilon, n + 1);
 
-    st.push (n);
-    st.push (n + 1);
+    st.push_back (n);
+    st.push_back (n + 1);
 }
 
 } // namespace detail
 
-nfa_t
-make_nfa (const string& s) {
-    detail::nfa_state_t state;
+void
+make_nfa (
+    const string& s, nfa_t& nfa, vector< size_t >& st,
+    vector< vector< pair< int, size_t > > >& spare) {
+    RETA_STATS_TIMER (make_nfa);
+
+    spare_states (nfa.states, spare);
+    nfa.accept.clear ();
+
+    st.clear ();
+
+    detail::nfa_state_t state { nfa, st, spare };
 
-    for (const auto c : s) {
-        assert (0 <= c && c <= (numeric_limits< char >::max) ());
+    for (size_t i = 0; i < s.size (); ++i) {
+        const auto c = s [i];
+        const auto b = (unsigned char)c;
+
+        assert (
+            (0 <= c && c <= (numeric_limits< char >::max) ()) ||
+            capture_tag_byte <= b);
 
         if ('a' <= c && c <= 'z')
             nfa_consume_literal (c, state);
+        else if (capture_tag_byte <= b)
+            nfa_consume_literal (nfa_t::tag (b - capture_tag_byte), state);
+        else if ('^' == c)
+            nfa_consume_literal (nfa_t::begin_anchor, state);
+        else if ('$' == c)
+            nfa_consume_literal (nfa_t::end_anchor, state);
+        else if ('{' == c)
+            nfa_consume_class (class_ranges (s, i), state);
         else if ('.' == c)
             nfa_consume_concatenation (state);
         else if ('*' == c)
@@ -192,12 +280,169 @@ make_nfa (const string& s) {
             assert (0);
     }
 
-    auto& nfa = state.nfa;
+    assert (1 < st.size ());
+
+    nfa.accept.emplace_back (st.back ());
+    nfa.start = st [st.size () - 2];
+
+    RETA_STATS_UPDATE ({
+            size_t n = 0;
 
-    nfa.accept.emplace_back (state.st.top ());
-    state.st.pop ();
+            for (const auto& ts : nfa.states)
+                n += ts.size ();
 
-    nfa.start = state.st.top ();
+            stats.nfa_states += nfa.states.size ();
+            stats.nfa_transitions += n;
 
-    return move (nfa);
+            stats.bytes (
+                nfa.states.size () * sizeof (nfa.states [0]) +
+                n * sizeof (nfa.states [0][0]));
+        });
 }
+
+nfa_t
+make_nfa (const string& s) {
+    nfa_t nfa;
+
+    vector< size_t > st;
+    vector< vector< pair< int, size_t > > > spare;
+
+    make_nfa (s, nfa, st, spare);
+
+    return nfa;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+//
+// Extends the set with every state reachable over epsilon transitions, and
+// over the anchors that hold at the position; the membership vector mirrors
+// the set:
+//
+template< typename Nfa >
+static void
+nfa_epsilon_closure (
+    const Nfa& nfa, vector< size_t >& states, vector< bool >& member,
+    bool begin = false, bool end = false) {
+    const auto follow = [&](const auto c) {
+        return Nfa::is_epsilon (c) ||
+            (begin && Nfa::begin_anchor == c) ||
+            (end && Nfa::end_anchor == c);
+    };
+
+    for (size_t i = 0; i < states.size (); ++i) {
+        for (const auto& t : nfa.states [states [i]]) {
+            if (follow (t.first) && !member [t.second]) {
+                member [t.second] = true;
+                states.push_back (t.second);
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+template< typename I, typename S >
+bool
+match (const basic_nfa_t< I, S >& nfa, const char* first, const char* last) {
+    nfa_scratch_t scratch;
+    return match (nfa, first, last, scratch);
+}
+
+template< typename I, typename S >
+bool
+match (
+    const basic_nfa_t< I, S >& nfa, const char* first, const char* last,
+    nfa_scratch_t& scratch) {
+    const auto n = nfa.states.size ();
+
+    auto& curr = scratch.curr;
+    auto& next = scratch.next;
+
+    auto& member = scratch.member;
+    auto& next_member = scratch.next_member;
+
+    curr.assign (1, nfa.start);
+    next.clear ();
+
+    member.assign (n, false);
+    next_member.assign (n, false);
+
+    member [nfa.start] = true;
+    detail::nfa_epsilon_closure (nfa, curr, member, true, first == last);
+
+    for (; first != last && !curr.empty (); ++first) {
+        const auto c = I (size_cast (*first));
+
+        for (const auto s : curr) {
+            for (const auto& t : nfa.states [s]) {
+                if (c == t.first && !next_member [t.second]) {
+                    next_member [t.second] = true;
+                    next.push_back (t.second);
+                }
+            }
+        }
+
+        detail::nfa_epsilon_closure (nfa, next, next_member);
+
+        for (const auto s : curr)
+            member [s] = false;
+
+        curr.swap (next);
+        member.swap (next_member);
+
+        next.clear ();
+    }
+
+    if (first != last)
+        return false;
+
+    //
+    // The end of the input, where $ holds:
+    //
+    detail::nfa_epsilon_closure (nfa, curr, member, false, true);
+
+    return any_of (curr.begin (), curr.end (), [&](const auto s) {
+        return nfa.accept.end () != find (
+            nfa.accept.begin (), nfa.accept.end (), s);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template bool match (
+    const basic_nfa_t< int, size_t >&, const char*, const char*);
+template bool match (
+    const basic_nfa_t< int, size_t >&, const char*, const char*,
+    nfa_scratch_t&);
+template istream& operator>> (istream&, basic_nfa_t< int, size_t >&);
+template ostream& operator<< (ostream&, const basic_nfa_t< int, size_t >&);
+
+template bool match (
+    const basic_nfa_t< int16_t, uint8_t >&, const char*, const char*);
+template bool match (
+    const basic_nfa_t< int16_t, uint8_t >&, const char*, const char*,
+    nfa_scratch_t&);
+template istream& operator>> (istream&, basic_nfa_t< int16_t, uint8_t >&);
+template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint8_t >&);
+
+template bool match (
+    const basic_nfa_t< int16_t, uint16_t >&, const char*, const char*);
+template bool match (
+    const basic_nfa_t< int16_t, uint16_t >&, const char*, const char*,
+    nfa_scratch_t&);
+template istream& operator>> (istream&, basic_nfa_t< int16_t, uint16_t >&);
+template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint16_t >&);
+
+template bool match (
+    const basic_nfa_t< int16_t, uint32_t >&, const char*, const char*);
+template bool match (
+    const basic_nfa_t< int16_t, uint32_t >&, const char*, const char*,
+    nfa_scratch_t&);
+template istream& operator>> (istream&, basic_nfa_t< int16_t, uint32_t >&);
+template ostream& operator<< (
+    ostream&, const basic_nfa_t< int16_t, uint32_t >&);
@@ -0,0 +1,137 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include <reta/parallel.hpp>
+#include <reta/util.hpp>
+
+//
+// Below this many bytes per chunk the threads cost more than they save:
+//
+static constexpr size_t min_chunk = 64 * 1024;
+
+//
+// How often the lanes are checked for states that have merged:
+//
+static constexpr size_t merge_interval = 16;
+
+vector< size_t >
+scan_all (const table_t& table, const char* first, const char* last) {
+    static constexpr size_t none = size_t (-1);
+
+    const auto n = table.dead + 1;
+
+    //
+    // The distinct current states other than the dead one, which absorbs, and
+    // the lane each initial state is in, none once it is dead:
+    //
+    vector< size_t > lanes (n - 1), lane (n, none);
+
+    for (size_t i = 0; i + 1 < n; ++i)
+        lanes [i] = lane [i] = i;
+
+    vector< size_t > index (n, none), renumber;
+
+    while (first != last && lanes.size () > 1) {
+        const auto stop = first + (min) (
+            size_t (last - first), merge_interval);
+
+        for (; first != stop; ++first) {
+            const auto c = size_cast (*first);
+
+            for (auto& s : lanes)
+                s = table.next [s * table_t::width + c];
+        }
+
+        //
+        // Merges the lanes in the same state, keeping the first of them, and
+        // drops those in the dead state:
+        //
+        renumber.resize (lanes.size ());
+        size_t k = 0;
+
+        for (size_t i = 0; i < lanes.size (); ++i) {
+            const auto s = lanes [i];
+
+            if (s != table.dead && none == index [s]) {
+                index [s] = k;
+                lanes [k++] = s;
+            }
+
+            renumber [i] = s == table.dead ? none : index [s];
+        }
+
+        for (size_t i = 0; i < k; ++i)
+            index [lanes [i]] = none;
+
+        lanes.resize (k);
+
+        for (auto& l : lane)
+            if (none != l)
+                l = renumber [l];
+    }
+
+    if (1 == lanes.size ()) {
+        auto s = lanes.front ();
+
+        for (; first != last && s != table.dead; ++first)
+            s = table.next [s * table_t::width + size_cast (*first)];
+
+        lanes.front () = s;
+    }
+
+    vector< size_t > mapping (n);
+
+    for (size_t i = 0; i < n; ++i)
+        mapping [i] = none == lane [i] ? table.dead : lanes [lane [i]];
+
+    return mapping;
+}
+
+bool
+match_parallel (
+    const table_t& table, const char* first, const char* last,
+    size_t threads) {
+    const auto size = size_t (last - first);
+
+    if (0 == threads)
+        threads = (max) (1U, thread::hardware_concurrency ());
+
+    threads = (min) (threads, size / min_chunk);
+
+    if (threads < 2)
+        return match (table, first, last);
+
+    const auto chunk = size / threads;
+
+    vector< vector< size_t > > mappings (threads);
+    vector< thread > workers;
+
+    for (size_t i = 1; i < threads; ++i) {
+        const auto lo = first + i * chunk;
+        const auto hi = i + 1 == threads ? last : lo + chunk;
+
+        workers.emplace_back ([&table, &mappings, i, lo, hi]() {
+                mappings [i] = scan_all (table, lo, hi);
+            });
+    }
+
+    auto s = table.start;
+
+    for (auto p = first, hi = first + chunk; p != hi && s != table.dead; ++p)
+        s = table.next [s * table_t::width + size_cast (*p)];
+
+    for (auto& w : workers)
+        w.join ();
+
+    for (size_t i = 1; i < threads; ++i)
+        s = mappings [i][s];
+
+    return table.accept [s];
+}
@@ -0,0 +1,301 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/pattern-set.hpp>
+#include <reta/stats.hpp>
+#include <reta/util.hpp>
+
+//
+// The signature of a state is its finality and its transitions; the in-degree
+// and the registration flag are bookkeeping:
+//
+size_t
+pattern_set_t::hash_t::operator() (const state_t& s) const {
+    size_t h = s.final;
+
+    for (const auto& t : s.next) {
+        h = h * 31 + hash< int > () (t.first);
+        h = h * 31 + hash< size_t > () (t.second);
+    }
+
+    return h;
+}
+
+bool
+pattern_set_t::equal_t::operator() (
+    const state_t& lhs, const state_t& rhs) const {
+    return lhs.final == rhs.final && lhs.next == rhs.next;
+}
+
+pattern_set_t::pattern_set_t () : size_ (), touched_ () {
+    root_ = make_state ();
+}
+
+size_t
+pattern_set_t::make_state () {
+    ++touched_;
+
+    if (free_.empty ()) {
+        states_.push_back (state_t { });
+        return states_.size () - 1;
+    }
+
+    const auto s = free_.back ();
+    free_.pop_back ();
+
+    states_ [s] = state_t { };
+
+    return s;
+}
+
+size_t
+pattern_set_t::clone (size_t s) {
+    const auto q = make_state ();
+
+    states_ [q].next = states_ [s].next;
+    states_ [q].final = states_ [s].final;
+
+    for (const auto& t : states_ [q].next)
+        ++states_ [t.second].in;
+
+    return q;
+}
+
+//
+// Drops one incoming transition; a state left without any is freed, along with
+// whatever only it referred to:
+//
+void
+pattern_set_t::release (size_t s) {
+    assert (states_ [s].in);
+
+    if (--states_ [s].in || s == root_)
+        return;
+
+    ++touched_;
+
+    unregister (s);
+
+    for (const auto& t : states_ [s].next)
+        release (t.second);
+
+    states_ [s].next.clear ();
+    free_.push_back (s);
+}
+
+void
+pattern_set_t::unregister (size_t s) {
+    if (states_ [s].registered) {
+        register_.erase (states_ [s]);
+        states_ [s].registered = false;
+    }
+}
+
+size_t
+pattern_set_t::target (size_t s, int c) const {
+    const auto& ts = states_ [s].next;
+
+    const auto iter = lower_bound (
+        ts.begin (), ts.end (), c, [](const auto& t, int c) {
+            return t.first < c;
+        });
+
+    return iter != ts.end () && iter->first == c ? iter->second : size_t (-1);
+}
+
+void
+pattern_set_t::set_target (size_t s, int c, size_t q) {
+    ++states_ [q].in;
+
+    auto& ts = states_ [s].next;
+
+    const auto iter = lower_bound (
+        ts.begin (), ts.end (), c, [](const auto& t, int c) {
+            return t.first < c;
+        });
+
+    if (iter != ts.end () && iter->first == c) {
+        const auto p = iter->second;
+        iter->second = q;
+
+        release (p);
+    }
+    else
+        ts.emplace (iter, c, q);
+}
+
+void
+pattern_set_t::remove_target (size_t s, int c) {
+    auto& ts = states_ [s].next;
+
+    const auto iter = find_if (ts.begin (), ts.end (), [c](const auto& t) {
+            return t.first == c;
+        });
+
+    assert (iter != ts.end ());
+
+    const auto p = iter->second;
+    ts.erase (iter);
+
+    release (p);
+}
+
+//
+// The states along the longest prefix of the pattern in the automaton, taken
+// out of the register since their right languages are about to change; from
+// the first state reached by more than one transition on, the path is cloned
+// so that the change does not leak to the other paths through it:
+//
+vector< size_t >
+pattern_set_t::prepare (const string& s) {
+    vector< size_t > path { root_ };
+
+    for (size_t i = 0; i < s.size (); ++i) {
+        const auto q = target (path.back (), size_cast (s [i]));
+
+        if (size_t (-1) == q)
+            break;
+
+        path.push_back (q);
+    }
+
+    size_t k = 0;
+
+    for (; k < path.size () && (0 == k || 1 == states_ [path [k]].in); ++k) {
+        ++touched_;
+        unregister (path [k]);
+    }
+
+    for (; k < path.size (); ++k) {
+        const auto q = clone (path [k]);
+
+        set_target (path [k - 1], size_cast (s [k - 1]), q);
+        path [k] = q;
+    }
+
+    return path;
+}
+
+//
+// Back from the end of the path: states which accept nothing are removed, the
+// others are replaced by an equivalent registered state, if there is one, or
+// registered:
+//
+void
+pattern_set_t::merge (const vector< size_t >& path, const string& s) {
+    for (size_t k = path.size () - 1; k > 0; --k) {
+        const auto q = path [k];
+        const auto c = size_cast (s [k - 1]);
+
+        if (!states_ [q].final && states_ [q].next.empty ()) {
+            remove_target (path [k - 1], c);
+            continue;
+        }
+
+        const auto iter = register_.find (states_ [q]);
+
+        RETA_STATS_UPDATE (
+            ++(iter == register_.end ()
+               ? stats.intern_misses : stats.intern_hits));
+
+        if (iter != register_.end ())
+            set_target (path [k - 1], c, iter->second);
+        else {
+            register_.emplace (states_ [q], q);
+            states_ [q].registered = true;
+        }
+    }
+}
+
+bool
+pattern_set_t::insert (const string& s) {
+    if (contains (s))
+        return false;
+
+    touched_ = 0;
+
+    auto path = prepare (s);
+
+    for (auto i = path.size () - 1; i < s.size (); ++i) {
+        const auto q = make_state ();
+
+        set_target (path.back (), size_cast (s [i]), q);
+        path.push_back (q);
+    }
+
+    states_ [path.back ()].final = true;
+    ++size_;
+
+    merge (path, s);
+
+    return true;
+}
+
+bool
+pattern_set_t::erase (const string& s) {
+    if (!contains (s))
+        return false;
+
+    touched_ = 0;
+
+    const auto path = prepare (s);
+    assert (path.size () == s.size () + 1);
+
+    states_ [path.back ()].final = false;
+    --size_;
+
+    merge (path, s);
+
+    return true;
+}
+
+bool
+pattern_set_t::contains (const string& s) const {
+    auto q = root_;
+
+    for (const auto c : s)
+        if (size_t (-1) == (q = target (q, size_cast (c))))
+            return false;
+
+    return states_ [q].final;
+}
+
+dfa_t
+pattern_set_t::to_dfa () const {
+    dfa_t dfa { };
+
+    vector< size_t > number (states_.size (), size_t (-1));
+    vector< size_t > queue { root_ };
+
+    number [root_] = 0;
+
+    for (size_t i = 0; i < queue.size (); ++i) {
+        const auto& q = states_ [queue [i]];
+
+        dfa.states.emplace_back ();
+
+        if (q.final)
+            dfa.accept.push_back (i);
+
+        for (const auto& t : q.next) {
+            if (size_t (-1) == number [t.second]) {
+                number [t.second] = queue.size ();
+                queue.push_back (t.second);
+            }
+
+            dfa.states [i].emplace_back (t.first, number [t.second]);
+        }
+    }
+
+    dfa.start = 0;
+
+    return dfa;
+}
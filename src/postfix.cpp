@@ -1,23 +1,190 @@
 // -*- mode: c++; -*-
 
 #include <cassert>
+#include <cctype>
+#include <cstdlib>
 
 #include <functional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 using namespace std;
 
-string
-postfix (const string& r) {
+#include <reta/nfa.hpp>
+#include <reta/stats.hpp>
+#include <reta/utf8.hpp>
+
+namespace detail {
+
+static inline bool
+postfix_is_class (char c) {
+    return '[' == c || '\\' == c || 0x80 <= (unsigned char)c;
+}
+
+//
+// The UTF-8 character at the position, which is left on its last byte:
+//
+static uint32_t
+postfix_char (const string& r, size_t& i) {
+    const char* first = r.data () + i;
+
+    uint32_t c = 0;
+
+    if (!decode_utf8 (first, r.data () + r.size (), c))
+        throw invalid_argument ("invalid UTF-8 in expression");
+
+    i = size_t (first - r.data ()) - 1;
+
+    return c;
+}
+
+//
+// The braced name, or hexadecimal number, after the position:
+//
+static string
+postfix_braced (const string& r, size_t& i) {
+    const auto pos = i + 1 < r.size () && '{' == r [i + 1]
+        ? r.find ('}', i + 2) : string::npos;
+
+    if (string::npos == pos)
+        throw invalid_argument ("expected braces after \\" + r.substr (i, 1));
+
+    const auto s = r.substr (i + 2, pos - i - 2);
+    i = pos;
+
+    return s;
+}
+
+//
+// \p{..} and \P{..}, a general category and its complement, \x{..}, a code
+// point, and otherwise the escaped character:
+//
+static code_point_ranges_t
+postfix_escape (const string& r, size_t& i) {
+    if (i + 1 == r.size ())
+        throw invalid_argument ("trailing backslash in expression");
+
+    const auto c = r [++i];
+
+    code_point_ranges_t ranges;
+
+    if ('p' == c || 'P' == c) {
+        const auto name = postfix_braced (r, i);
+
+        if (!unicode_property (name, ranges))
+            throw invalid_argument ("unknown property " + name);
+
+        if ('P' == c)
+            ranges = complement (ranges);
+    }
+    else if ('x' == c) {
+        const auto digits = postfix_braced (r, i);
+
+        char* end = 0;
+        const auto x = strtoul (digits.c_str (), &end, 16);
+
+        if (digits.empty () || *end || !isxdigit ((unsigned char)digits [0]) ||
+            max_code_point < x)
+            throw invalid_argument ("invalid code point " + digits);
+
+        ranges.emplace_back (uint32_t (x), uint32_t (x));
+    }
+    else {
+        const auto x = postfix_char (r, i);
+        ranges.emplace_back (x, x);
+    }
+
+    return ranges;
+}
+
+static code_point_ranges_t
+postfix_class_item (const string& r, size_t& i) {
+    if ('\\' == r [i])
+        return postfix_escape (r, i);
+
+    const auto x = postfix_char (r, i);
+    return { { x, x } };
+}
+
+//
+// A bracketed class of characters, ranges and escapes, complemented by a
+// leading ^, or a single escape or UTF-8 character, as canonical ranges; the
+// position is left on its last byte:
+//
+static code_point_ranges_t
+postfix_class (const string& r, size_t& i) {
+    if ('[' != r [i]) {
+        auto ranges = postfix_class_item (r, i);
+        canonicalize (ranges);
+
+        return ranges;
+    }
+
+    const bool negated = i + 1 < r.size () && '^' == r [i + 1];
+    i += 1 + negated;
+
+    code_point_ranges_t ranges;
+
+    for (; i < r.size () && ']' != r [i]; ++i) {
+        const auto xs = postfix_class_item (r, i);
+
+        const auto single = 1 == xs.size () && xs [0].first == xs [0].second;
+
+        if (single && i + 2 < r.size () && '-' == r [i + 1] &&
+            ']' != r [i + 2]) {
+            i += 2;
+
+            const auto ys = postfix_class_item (r, i);
+
+            if (1 != ys.size () || ys [0].first != ys [0].second ||
+                ys [0].second < xs [0].first)
+                throw invalid_argument ("invalid range in class");
+
+            ranges.emplace_back (xs [0].first, ys [0].second);
+        }
+        else
+            ranges.insert (ranges.end (), xs.begin (), xs.end ());
+    }
+
+    if (i == r.size ())
+        throw invalid_argument ("unterminated class in expression");
+
+    canonicalize (ranges);
+
+    return negated ? complement (ranges) : ranges;
+}
+
+//
+// The operands besides classes: the literals and the anchors, and the tags on
+// the tag pass:
+//
+static inline bool
+postfix_is_operand (char c, bool tags) {
+    return ('a' <= c && c <= 'z') || '^' == c || '$' == c ||
+        (tags && capture_tag_byte <= (unsigned char)c);
+}
+
+//
+// Bytes past ASCII are tags once postfix_captures has put them in, and UTF-8
+// characters otherwise. Every group and alternative is checked to hold an
+// operand, and the parentheses to balance, before the operators are put out:
+//
+static void
+postfix (
+    const string& r, bool tags, string& s,
+    vector< pair< size_t, size_t > >& st) {
+    RETA_STATS_TIMER (postfix);
+
     size_t a = 0, x = 0;
 
-    vector< pair< size_t, size_t > > st;
-    st.reserve (16);
+    s.clear ();
+    st.clear ();
 
-    string s;
+    for (size_t i = 0; i < r.size (); ++i) {
+        const auto c = r [i];
 
-    for (const auto c : r) {
         switch (c) {
         case '(':
             if (x > 1) {
@@ -31,7 +198,8 @@ postfix (const string& r) {
             break;
 
         case '|':
-            assert (x);
+            if (0 == x)
+                throw invalid_argument ("empty alternative in expression");
 
             while (--x > 0)
                 s += '.';
@@ -40,6 +208,14 @@ postfix (const string& r) {
             break;
 
         case ')':
+            if (st.empty ())
+                throw invalid_argument ("unmatched ) in expression");
+
+            if (0 == x)
+                throw invalid_argument (
+                    a ? "empty alternative in expression"
+                      : "empty group in expression");
+
             while (--x)
                 s += '.';
 
@@ -53,7 +229,9 @@ postfix (const string& r) {
             break;
 
         case '*':
-            assert (x);
+            if (0 == x)
+                throw invalid_argument ("* without an operand in expression");
+
             s += c;
             break;
 
@@ -63,17 +241,157 @@ postfix (const string& r) {
                 s += '.';
             }
 
-            s += c;
+            //
+            // Braces are the operands of classes in the output, which only
+            // the tag pass takes back in, escaped as \{ otherwise:
+            //
+            if ('{' == c && !tags)
+                throw invalid_argument ("unescaped { in expression");
+
+            if ('{' == c) {
+                const auto pos = r.find ('}', i);
+                assert (string::npos != pos);
+
+                s.append (r, i, pos - i + 1);
+                i = pos;
+            }
+            else if (!tags && postfix_is_class (c))
+                s += class_operand (postfix_class (r, i));
+            else if (postfix_is_operand (c, tags))
+                s += c;
+            else
+                throw invalid_argument (
+                    string ("unexpected ") + c + " in expression");
+
             x++;
             break;
         }
     }
 
+    if (!st.empty ())
+        throw invalid_argument ("unmatched ( in expression");
+
+    if (0 == x)
+        throw invalid_argument (
+            a ? "empty alternative in expression" : "empty expression");
+
     while (--x > 0)
         s += '.';
 
     for (; a > 0; --a)
         s += '|';
+}
+
+static string
+postfix (const string& r, bool tags) {
+    string s;
+
+    vector< pair< size_t, size_t > > st;
+    st.reserve (16);
+
+    postfix (r, tags, s, st);
 
     return s;
 }
+
+} // namespace detail
+
+string
+postfix (const string& r) {
+    return detail::postfix (r, false);
+}
+
+void
+postfix (
+    const string& r, string& s, vector< pair< size_t, size_t > >& st) {
+    detail::postfix (r, false, s, st);
+}
+
+string
+class_operand (const code_point_ranges_t& ranges) {
+    ostringstream ss;
+    ss << hex << '{';
+
+    for (size_t i = 0; i < ranges.size (); ++i)
+        ss << (i ? "," : "") << ranges [i].first << '-' << ranges [i].second;
+
+    ss << '}';
+
+    return ss.str ();
+}
+
+code_point_ranges_t
+class_ranges (const string& s, size_t& i) {
+    assert ('{' == s [i]);
+
+    code_point_ranges_t ranges;
+
+    const char* p = s.data () + i + 1;
+
+    for (char* end = 0; '}' != *p; p = end) {
+        if (',' == *p)
+            ++p;
+
+        const auto lo = uint32_t (strtoul (p, &end, 16));
+        assert ('-' == *end);
+
+        const auto hi = uint32_t (strtoul (end + 1, &end, 16));
+        ranges.emplace_back (lo, hi);
+    }
+
+    i = size_t (p - s.data ());
+
+    return ranges;
+}
+
+string
+postfix_captures (const string& r, size_t* groups) {
+    const auto tag = [](size_t i) {
+        return char (capture_tag_byte + i);
+    };
+
+    size_t n = 1;
+    vector< size_t > st;
+
+    string s;
+
+    //
+    // The tags go around the parenthesized group, inside another pair of
+    // parentheses for a closure of the group to repeat both:
+    //
+    for (size_t i = 0; i < r.size (); ++i) {
+        const auto c = r [i];
+
+        if ('(' == c) {
+            if (n == max_capture_groups)
+                throw invalid_argument ("too many groups in expression");
+
+            st.push_back (n);
+
+            s += '(';
+            s += tag (2 * n++);
+            s += '(';
+        }
+        else if (')' == c) {
+            if (st.empty ())
+                throw invalid_argument ("unmatched ) in expression");
+
+            s += ')';
+            s += tag (2 * st.back () + 1);
+            s += ')';
+
+            st.pop_back ();
+        }
+        else if ('{' == c)
+            throw invalid_argument ("unescaped { in expression");
+        else if (detail::postfix_is_class (c))
+            s += class_operand (detail::postfix_class (r, i));
+        else
+            s += c;
+    }
+
+    if (groups)
+        *groups = n;
+
+    return detail::postfix (tag (0) + ('(' + s + ')') + tag (1), true);
+}
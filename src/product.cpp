@@ -0,0 +1,188 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#include <reta/product.hpp>
+#include <reta/stats.hpp>
+
+namespace detail {
+
+enum struct operation_t { intersection, alternation, difference };
+
+static constexpr size_t alphabet_size = 256;
+static constexpr size_t dead = size_t (-1);
+
+static inline bool
+combine (operation_t op, bool lhs, bool rhs) {
+    switch (op) {
+    case operation_t::intersection: return lhs && rhs;
+    case operation_t::alternation:  return lhs || rhs;
+    case operation_t::difference:   return lhs && !rhs;
+    }
+
+    return false;
+}
+
+static inline vector< bool >
+final_states_of (const dfa_t& dfa) {
+    vector< bool > v (dfa.states.size ());
+
+    for (const auto s : dfa.accept)
+        v [s] = true;
+
+    return v;
+}
+
+static dfa_t
+product (const dfa_t& a, const dfa_t& b, operation_t op) {
+    RETA_STATS_TIMER (make_dfa);
+
+    const auto fa = final_states_of (a), fb = final_states_of (b);
+
+    //
+    // The missing transitions of either side lead to its implicit dead state;
+    // pairs which cannot accept whatever follows are not explored:
+    //
+    const auto viable = [op](size_t i, size_t j) {
+        switch (op) {
+        case operation_t::intersection: return i != dead && j != dead;
+        case operation_t::alternation:  return i != dead || j != dead;
+        case operation_t::difference:   return i != dead;
+        }
+
+        return false;
+    };
+
+    const auto key = [&](size_t i, size_t j) {
+        return (i == dead ? dead_state (a) : i) * (dead_state (b) + 1) +
+            (j == dead ? dead_state (b) : j);
+    };
+
+    unordered_map< size_t, size_t > states;
+    vector< pair< size_t, size_t > > queue { { a.start, b.start } };
+
+    states.emplace (key (a.start, b.start), 0);
+
+    dfa_t dfa { };
+
+    for (size_t from = 0; from < queue.size (); ++from) {
+        const auto i = queue [from].first, j = queue [from].second;
+
+        static const vector< pair< int, size_t > > none;
+
+        const auto& ts = i == dead ? none : a.states [i];
+        const auto& us = j == dead ? none : b.states [j];
+
+        if (combine (op, i != dead && fa [i], j != dead && fb [j]))
+            dfa.accept.push_back (from);
+
+        dfa.states.emplace_back ();
+
+        //
+        // Merge of the two transition lists, both sorted by symbol:
+        //
+        auto t = ts.begin (), u = us.begin ();
+
+        while (t != ts.end () || u != us.end ()) {
+            const auto c = (min) (
+                t == ts.end () ? int (alphabet_size) : t->first,
+                u == us.end () ? int (alphabet_size) : u->first);
+
+            auto p = dead, q = dead;
+
+            if (t != ts.end () && t->first == c)
+                p = (t++)->second;
+
+            if (u != us.end () && u->first == c)
+                q = (u++)->second;
+
+            if (!viable (p, q))
+                continue;
+
+            const auto iter = states.emplace (key (p, q), queue.size ()).first;
+
+            if (iter->second == queue.size ())
+                queue.emplace_back (p, q);
+
+            dfa.states [from].emplace_back (c, iter->second);
+        }
+    }
+
+    dfa.start = 0;
+
+    RETA_STATS_UPDATE ({
+            stats.dfa_states += dfa.states.size ();
+
+            for (const auto& ts : dfa.states)
+                stats.dfa_transitions += ts.size ();
+        });
+
+    return trim (dfa);
+}
+
+} // namespace detail
+
+static inline dfa_t
+finish (dfa_t dfa, bool minimize) {
+    return minimize ? minimize_dfa (dfa) : dfa;
+}
+
+dfa_t
+intersect (const dfa_t& a, const dfa_t& b, bool minimize) {
+    return finish (
+        detail::product (a, b, detail::operation_t::intersection), minimize);
+}
+
+dfa_t
+unite (const dfa_t& a, const dfa_t& b, bool minimize) {
+    return finish (
+        detail::product (a, b, detail::operation_t::alternation), minimize);
+}
+
+dfa_t
+difference (const dfa_t& a, const dfa_t& b, bool minimize) {
+    return finish (
+        detail::product (a, b, detail::operation_t::difference), minimize);
+}
+
+dfa_t
+complement (const dfa_t& src, bool minimize) {
+    using detail::alphabet_size;
+
+    const auto n = src.states.size ();
+    const auto f = detail::final_states_of (src);
+
+    //
+    // Completed with an accepting sink, n, for everything the source rejects
+    // by running out of transitions:
+    //
+    dfa_t dfa { };
+    dfa.states.resize (n + 1);
+
+    static const vector< pair< int, size_t > > none;
+
+    for (size_t i = 0; i <= n; ++i) {
+        const auto& ts = i < n ? src.states [i] : none;
+        auto t = ts.begin ();
+
+        for (size_t c = 0; c < alphabet_size; ++c) {
+            if (t != ts.end () && size_t (t->first) == c)
+                dfa.states [i].emplace_back (int (c), (t++)->second);
+            else
+                dfa.states [i].emplace_back (int (c), n);
+        }
+
+        if (i == n || !f [i])
+            dfa.accept.push_back (i);
+    }
+
+    dfa.start = src.start;
+
+    return finish (trim (dfa), minimize);
+}
@@ -0,0 +1,102 @@
+// -*- mode: c++; -*-
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/regex.hpp>
+
+regex_handle_t
+compile_regex (const string& r, const regex_options_t& options) {
+    auto p = make_shared< compiled_regex_t > ();
+
+    p->pattern = r;
+    p->nfa = make_nfa (simplify (postfix (r)));
+
+    //
+    // The simulated NFA and the TDFA match whole inputs, so does the table:
+    //
+    auto dfa_options = options.dfa;
+    dfa_options.unanchored = dfa_options.earliest = false;
+
+    dfa_t dfa;
+
+    if (dfa_status_t::ok == make_dfa (p->nfa, dfa_options, dfa))
+        p->table = make_unique< const table_t > (minimize_dfa (dfa));
+
+    if (options.captures) {
+        size_t groups = 0;
+
+        const auto nfa = make_nfa (postfix_captures (r, &groups));
+        p->tdfa = make_unique< const tdfa_t > (make_tdfa (nfa, 2 * groups));
+    }
+
+    return p;
+}
+
+bool
+match (
+    const compiled_regex_t& regex, const char* first, const char* last,
+    match_scratch_t& scratch) {
+    return regex.table
+        ? match (*regex.table, first, last)
+        : match (regex.nfa, first, last, scratch.nfa);
+}
+
+bool
+match (
+    const compiled_regex_t& regex, const char* first, const char* last,
+    captures_t& captures, match_scratch_t& scratch) {
+    if (!regex.tdfa)
+        throw logic_error ("expression compiled without captures");
+
+    return match (*regex.tdfa, first, last, captures, scratch.registers);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+scratch_pool_t::lease_t::lease_t (
+    scratch_pool_t& pool, unique_ptr< match_scratch_t > scratch)
+    : pool_ (&pool), scratch_ (move (scratch)) {
+    if (!scratch_)
+        scratch_ = make_unique< match_scratch_t > ();
+}
+
+scratch_pool_t::lease_t::~lease_t () {
+    if (!scratch_)
+        return;
+
+    lock_guard< mutex > lock (pool_->mutex_);
+    pool_->free_.push_back (move (scratch_));
+}
+
+scratch_pool_t::lease_t
+scratch_pool_t::acquire () {
+    unique_ptr< match_scratch_t > scratch;
+
+    {
+        lock_guard< mutex > lock (mutex_);
+
+        if (free_.empty ())
+            ++size_;
+        else {
+            scratch = move (free_.back ());
+            free_.pop_back ();
+        }
+    }
+
+    //
+    // Created outside of the lock, in the leasing thread:
+    //
+    return lease_t (*this, move (scratch));
+}
+
+size_t
+scratch_pool_t::size () const {
+    lock_guard< mutex > lock (mutex_);
+    return size_;
+}
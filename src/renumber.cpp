@@ -0,0 +1,153 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/renumber.hpp>
+#include <reta/util.hpp>
+
+namespace detail {
+
+static vector< size_t >
+bfs_order (const dfa_t& dfa) {
+    vector< bool > seen (dfa.states.size ());
+    vector< size_t > order { dfa.start };
+
+    seen [dfa.start] = true;
+
+    for (size_t i = 0; i < order.size (); ++i)
+        for (const auto& t : dfa.states [order [i]])
+            if (!seen [t.second]) {
+                seen [t.second] = true;
+                order.push_back (t.second);
+            }
+
+    return order;
+}
+
+static vector< size_t >
+dfs_order (const dfa_t& dfa) {
+    vector< bool > seen (dfa.states.size ());
+    vector< size_t > order, st { dfa.start };
+
+    while (!st.empty ()) {
+        const auto s = st.back ();
+        st.pop_back ();
+
+        if (seen [s])
+            continue;
+
+        seen [s] = true;
+        order.push_back (s);
+
+        //
+        // Pushed in reverse so that the lowest symbol is followed first:
+        //
+        const auto& ts = dfa.states [s];
+
+        for (auto iter = ts.rbegin (); iter != ts.rend (); ++iter)
+            if (!seen [iter->second])
+                st.push_back (iter->second);
+    }
+
+    return order;
+}
+
+//
+// Applies the order, a list of the states in their new positions, completed
+// with the states it misses:
+//
+static dfa_t
+apply (const dfa_t& src, vector< size_t > order) {
+    const auto n = src.states.size ();
+
+    vector< size_t > number (n, size_t (-1));
+
+    for (size_t i = 0; i < order.size (); ++i)
+        number [order [i]] = i;
+
+    for (size_t i = 0; i < n; ++i)
+        if (size_t (-1) == number [i]) {
+            number [i] = order.size ();
+            order.push_back (i);
+        }
+
+    dfa_t dst { };
+    dst.states.resize (n);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto& ts = dst.states [number [i]];
+
+        for (const auto& t : src.states [i])
+            ts.emplace_back (t.first, number [t.second]);
+    }
+
+    for (const auto s : src.accept)
+        dst.accept.push_back (number [s]);
+
+    sort (dst.accept.begin (), dst.accept.end ());
+
+    dst.start = number [src.start];
+
+    return dst;
+}
+
+} // namespace detail
+
+vector< size_t >
+profile (const dfa_t& dfa, const vector< string >& input) {
+    vector< size_t > counts (dfa.states.size ());
+
+    for (const auto& s : input) {
+        auto q = dfa.start;
+
+        ++counts [q];
+
+        for (const auto c : s) {
+            const auto& ts = dfa.states [q];
+
+            const auto iter = lower_bound (
+                ts.begin (), ts.end (), int (size_cast (c)),
+                [](const auto& t, int c) { return t.first < c; });
+
+            if (iter == ts.end () || iter->first != int (size_cast (c)))
+                break;
+
+            ++counts [q = iter->second];
+        }
+    }
+
+    return counts;
+}
+
+dfa_t
+renumber (const dfa_t& dfa, order_t order) {
+    switch (order) {
+    case order_t::bfs:
+        return detail::apply (dfa, detail::bfs_order (dfa));
+
+    case order_t::dfs:
+        return detail::apply (dfa, detail::dfs_order (dfa));
+    }
+
+    return dfa;
+}
+
+dfa_t
+renumber (const dfa_t& dfa, const vector< size_t >& counts) {
+    assert (counts.size () == dfa.states.size ());
+
+    auto order = detail::bfs_order (dfa);
+
+    stable_sort (order.begin (), order.end (), [&](auto lhs, auto rhs) {
+            return counts [lhs] > counts [rhs];
+        });
+
+    return detail::apply (dfa, move (order));
+}
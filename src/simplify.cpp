@@ -0,0 +1,330 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/stats.hpp>
+
+namespace detail {
+
+//
+// The expression tree, with n-ary concatenations and alternations; the
+// operands keep their postfix form, a literal, an anchor or a class:
+//
+struct regex_node_t {
+    char op;
+    string operand;
+    vector< regex_node_t > children;
+};
+
+static bool
+operator== (const regex_node_t& lhs, const regex_node_t& rhs) {
+    return lhs.op == rhs.op && lhs.operand == rhs.operand &&
+        lhs.children == rhs.children;
+}
+
+static regex_node_t
+make_node (char op, vector< regex_node_t > children) {
+    if (op && 1 == children.size () && '*' != op)
+        return move (children.front ());
+
+    //
+    // Nested concatenations and alternations are flattened:
+    //
+    regex_node_t x { op, { }, { } };
+
+    for (auto& y : children) {
+        if (op == y.op && '*' != op)
+            x.children.insert (
+                x.children.end (), make_move_iterator (y.children.begin ()),
+                make_move_iterator (y.children.end ()));
+        else
+            x.children.push_back (move (y));
+    }
+
+    return x;
+}
+
+static regex_node_t
+simplify_parse (const string& s) {
+    vector< regex_node_t > st;
+
+    for (size_t i = 0; i < s.size (); ++i) {
+        const auto c = s [i];
+
+        if ('.' == c || '|' == c) {
+            assert (1 < st.size ());
+
+            auto rhs = move (st.back ());
+            st.pop_back ();
+
+            auto lhs = move (st.back ());
+            st.pop_back ();
+
+            vector< regex_node_t > v;
+
+            v.push_back (move (lhs));
+            v.push_back (move (rhs));
+
+            st.push_back (make_node (c, move (v)));
+        }
+        else if ('*' == c) {
+            assert (!st.empty ());
+
+            vector< regex_node_t > v;
+            v.push_back (move (st.back ()));
+
+            st.back () = make_node ('*', move (v));
+        }
+        else {
+            const auto j = '{' == c ? s.find ('}', i) : i;
+            assert (string::npos != j);
+
+            st.push_back ({ 0, s.substr (i, j - i + 1), { } });
+            i = j;
+        }
+    }
+
+    assert (1 == st.size ());
+
+    return move (st.back ());
+}
+
+static void
+simplify_emit (const regex_node_t& x, string& s) {
+    if (0 == x.op) {
+        s += x.operand;
+        return;
+    }
+
+    for (size_t i = 0; i < x.children.size (); ++i) {
+        simplify_emit (x.children [i], s);
+
+        if (i)
+            s += x.op;
+    }
+
+    if ('*' == x.op)
+        s += '*';
+}
+
+//
+// Literals and classes, the operands that stand for one character:
+//
+static bool
+simplify_is_char (const regex_node_t& x) {
+    return 0 == x.op && (
+        '{' == x.operand [0] || ('a' <= x.operand [0] && x.operand [0] <= 'z'));
+}
+
+static code_point_ranges_t
+simplify_ranges (const regex_node_t& x) {
+    if ('{' != x.operand [0])
+        return { { uint32_t (x.operand [0]), uint32_t (x.operand [0]) } };
+
+    size_t i = 0;
+    return class_ranges (x.operand, i);
+}
+
+static regex_node_t simplify_alternation (vector< regex_node_t >);
+
+//
+// The alternatives that start, or end, with the same factor are replaced by
+// the factor and the alternation of the rest, at the place of the first one;
+// an alternative that is the factor alone stays apart, there being no empty
+// expression for its rest:
+//
+static vector< regex_node_t >
+simplify_factor (vector< regex_node_t > xs, bool prefix) {
+    const auto factor = [&](const regex_node_t& x) -> const regex_node_t& {
+        return prefix ? x.children.front () : x.children.back ();
+    };
+
+    const auto factorable = [](const regex_node_t& x) {
+        return '.' == x.op;
+    };
+
+    vector< regex_node_t > result;
+    vector< bool > done (xs.size ());
+
+    for (size_t i = 0; i < xs.size (); ++i) {
+        if (done [i])
+            continue;
+
+        vector< size_t > same;
+
+        for (size_t j = i; factorable (xs [i]) && j < xs.size (); ++j)
+            if (!done [j] && factorable (xs [j]) &&
+                factor (xs [j]) == factor (xs [i]))
+                same.push_back (j);
+
+        if (same.size () < 2) {
+            result.push_back (move (xs [i]));
+            continue;
+        }
+
+        auto f = factor (xs [i]);
+
+        vector< regex_node_t > rest;
+
+        for (const auto j : same) {
+            done [j] = true;
+
+            auto& v = xs [j].children;
+
+            rest.push_back (make_node ('.', prefix
+                ? vector< regex_node_t > (
+                    make_move_iterator (v.begin () + 1),
+                    make_move_iterator (v.end ()))
+                : vector< regex_node_t > (
+                    make_move_iterator (v.begin ()),
+                    make_move_iterator (v.end () - 1))));
+        }
+
+        vector< regex_node_t > v;
+
+        if (prefix) {
+            v.push_back (move (f));
+            v.push_back (simplify_alternation (move (rest)));
+        }
+        else {
+            v.push_back (simplify_alternation (move (rest)));
+            v.push_back (move (f));
+        }
+
+        result.push_back (make_node ('.', move (v)));
+    }
+
+    return result;
+}
+
+//
+// Duplicates are dropped, the characters merged into one class, and common
+// prefixes and suffixes factored out:
+//
+static regex_node_t
+simplify_alternation (vector< regex_node_t > xs) {
+    vector< regex_node_t > v;
+
+    code_point_ranges_t chars;
+    size_t pos = 0, n = 0;
+
+    for (auto& x : xs) {
+        if (v.end () != find (v.begin (), v.end (), x))
+            continue;
+
+        if (simplify_is_char (x)) {
+            const auto rs = simplify_ranges (x);
+            chars.insert (chars.end (), rs.begin (), rs.end ());
+
+            if (0 == n++)
+                pos = v.size ();
+            else
+                continue;
+        }
+
+        v.push_back (move (x));
+    }
+
+    if (n > 1) {
+        canonicalize (chars);
+
+        auto& x = v [pos].operand;
+
+        if (1 == chars.size () && chars [0].first == chars [0].second &&
+            'a' <= chars [0].first && chars [0].first <= 'z')
+            x = string (1, char (chars [0].first));
+        else
+            x = class_operand (chars);
+    }
+
+    v = simplify_factor (move (v), true);
+    v = simplify_factor (move (v), false);
+
+    return make_node ('|', move (v));
+}
+
+static regex_node_t
+simplify (regex_node_t x) {
+    for (auto& y : x.children)
+        y = simplify (move (y));
+
+    switch (x.op) {
+    case '*': {
+        auto y = move (x.children.front ());
+
+        //
+        // (y*)* is y*, and (y*|z)* is (y|z)*:
+        //
+        if ('*' == y.op) {
+            auto z = move (y.children.front ());
+            y = move (z);
+        }
+        else if ('|' == y.op) {
+            for (auto& z : y.children)
+                if ('*' == z.op) {
+                    auto w = move (z.children.front ());
+                    z = move (w);
+                }
+
+            y = simplify_alternation (move (y.children));
+        }
+
+        vector< regex_node_t > v;
+        v.push_back (move (y));
+
+        return make_node ('*', move (v));
+    }
+
+    case '|':
+        return simplify_alternation (move (x.children));
+
+    case '.':
+        return make_node ('.', move (x.children));
+
+    default:
+        return x;
+    }
+}
+
+} // namespace detail
+
+string
+simplify (const string& s) {
+    //
+    // Counted as part of the postfix stage, the front end:
+    //
+    RETA_STATS_TIMER (postfix);
+
+    //
+    // The alternatives of a capture expression carry priorities, and its tags
+    // positions, that the rewrites do not keep:
+    //
+    if (any_of (s.begin (), s.end (), [](const auto c) {
+                return capture_tag_byte <= (unsigned char)c;
+            }))
+        return s;
+
+    using namespace detail;
+
+    //
+    // A rewrite may enable others above it, e.g., a factored alternative
+    // becoming a duplicate; the passes stop once the expression stays put:
+    //
+    for (string result = s;;) {
+        string t;
+        simplify_emit (simplify (simplify_parse (result)), t);
+
+        if (t == result)
+            return t;
+
+        result = move (t);
+    }
+}
@@ -0,0 +1,95 @@
+// -*- mode: c++; -*-
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include <reta/stats.hpp>
+
+static thread_local stats_t* current_stats = 0;
+
+/* static */ stats_t*
+stats_t::current () {
+    return current_stats;
+}
+
+void
+stats_t::closure (size_t n) {
+    size_t k = 0;
+
+    for (; n > 1; n >>= 1)
+        ++k;
+
+    if (k >= closure_sizes.size ())
+        closure_sizes.resize (k + 1);
+
+    ++closure_sizes [k];
+}
+
+void
+stats_t::bytes (size_t n) {
+    peak_bytes = (max) (peak_bytes, n);
+}
+
+ostream& operator<< (ostream& ss, const stats_t& stats) {
+    const auto stage = [&](const char* name, const stats_t::stage_t& arg) {
+        ss << name << ": " << arg.calls << " calls, "
+           << chrono::duration_cast< chrono::microseconds > (
+               arg.wall).count () << " us\n";
+    };
+
+    stage ("postfix  ", stats.postfix);
+    stage ("make_nfa ", stats.make_nfa);
+    stage ("make_dfa ", stats.make_dfa);
+    stage ("minimize ", stats.minimize);
+
+    ss << "nfa      : " << stats.nfa_states << " states, "
+       << stats.nfa_transitions << " transitions\n";
+
+    ss << "dfa      : " << stats.dfa_states << " states, "
+       << stats.dfa_transitions << " transitions\n";
+
+    ss << "closures :";
+
+    for (size_t i = 0; i < stats.closure_sizes.size (); ++i)
+        ss << ' ' << (size_t (1) << i) << ':' << stats.closure_sizes [i];
+
+    ss << "\n";
+
+    const auto lookups = stats.intern_hits + stats.intern_misses;
+
+    ss << "interned : " << stats.intern_hits << '/' << lookups << " hits\n";
+    ss << "sweeps   : " << stats.minimization_sweeps << "\n";
+    ss << "trimmed  : " << stats.trimmed_unreachable << " unreachable, "
+       << stats.trimmed_dead << " dead\n";
+    ss << "peak     : " << stats.peak_bytes << " bytes\n";
+
+    return ss;
+}
+
+stats_scope_t::stats_scope_t (stats_t& stats)
+    : prev_ (current_stats) {
+    current_stats = &stats;
+}
+
+stats_scope_t::~stats_scope_t () {
+    current_stats = prev_;
+}
+
+stats_timer_t::stats_timer_t (stats_t::stage_t stats_t::*stage)
+    : stage_ (stage), start_ (chrono::steady_clock::now ())
+    { }
+
+stats_timer_t::~stats_timer_t () {
+    if (current_stats) {
+        auto& stage = current_stats->*stage_;
+
+        stage.wall += chrono::duration_cast< stats_t::duration_type > (
+            chrono::steady_clock::now () - start_);
+
+        ++stage.calls;
+    }
+}
@@ -0,0 +1,110 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+#include <reta/table.hpp>
+#include <reta/util.hpp>
+
+/* static */ constexpr table_t::size_type table_t::width /* = 256 */;
+
+table_t::table_t (const dfa_t& dfa)
+    : start (dfa.start), dead (dead_state (dfa)) {
+    const auto n = dead + 1;
+
+    next.resize (n * width, dead);
+    accept.resize (n);
+
+    for (size_t i = 0; i < dfa.states.size (); ++i) {
+        for (const auto& t : dfa.states [i]) {
+            assert (0 <= t.first && size_t (t.first) < width);
+            next [i * width + t.first] = t.second;
+        }
+    }
+
+    for (const auto s : dfa.accept)
+        accept [s] = true;
+}
+
+bool
+match (const table_t& table, const char* first, const char* last) {
+    auto s = table.start;
+
+    for (; first != last && s != table.dead; ++first)
+        s = table.next [s * table_t::width + size_cast (*first)];
+
+    return table.accept [s];
+}
+
+/* static */ constexpr tiered_table_t::hot_type tiered_table_t::escape;
+
+tiered_table_t::tiered_table_t (const dfa_t& dfa, size_type bytes)
+    : cold (dfa) {
+    hot_states = (min) (
+        dfa.states.size (), bytes / (table_t::width * sizeof (hot_type)));
+
+    hot_states = (min) (hot_states, size_type (escape));
+
+    hot.resize (hot_states * table_t::width);
+
+    for (size_t i = 0; i < hot.size (); ++i) {
+        const auto s = cold.next [i];
+        hot [i] = s < hot_states ? hot_type (s) : escape;
+    }
+}
+
+bool
+match (const tiered_table_t& table, const char* first, const char* last) {
+    const auto& cold = table.cold;
+
+    auto s = cold.start;
+
+    for (; first != last && s != cold.dead; ++first) {
+        const auto i = s * table_t::width + size_cast (*first);
+
+        if (s < table.hot_states) {
+            const auto t = table.hot [i];
+
+            if (t != tiered_table_t::escape) {
+                s = t;
+                continue;
+            }
+        }
+
+        s = cold.next [i];
+    }
+
+    return cold.accept [s];
+}
+
+/* static */ constexpr search_table_t::size_type search_table_t::npos;
+
+search_table_t::search_table_t (const dfa_t& dfa)
+    : table (dfa), sink (npos) {
+    const auto w = table_t::width;
+
+    for (size_t s = 0; s < table.dead && npos == sink; ++s) {
+        const auto first = table.next.begin () + s * w;
+
+        if (table.accept [s] && all_of (first, first + w, [&](const auto t) {
+                    return t == s;
+                }))
+            sink = s;
+    }
+}
+
+bool
+search (const search_table_t& table, const char* first, const char* last) {
+    const auto& dense = table.table;
+
+    auto s = dense.start;
+
+    for (; first != last && s != dense.dead && s != table.sink; ++first)
+        s = dense.next [s * table_t::width + size_cast (*first)];
+
+    return dense.accept [s];
+}
@@ -0,0 +1,524 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+#include <reta/tdfa.hpp>
+
+/* static */ constexpr tdfa_t::size_type tdfa_t::position;
+
+namespace detail {
+
+using tdfa_register_t = tdfa_t::size_type;
+using tdfa_op_t = tdfa_t::op_type;
+
+//
+// A state of the tagged NFA and the registers of its tags:
+//
+struct tdfa_config_t {
+    size_t state;
+    vector< tdfa_register_t > regs;
+};
+
+using tdfa_kernel_t = vector< tdfa_config_t >;
+
+//
+// Placeholder for the scratch register of the copy cycles, numbered after all
+// others once their count is known:
+//
+static constexpr tdfa_register_t tdfa_scratch = tdfa_t::position - 1;
+
+//
+// Closure in priority order: depth-first, through the transitions in the order
+// of their construction, the first path to reach a state taking it. Only the
+// states with a symbol transition, or accepting, are kept. A tag taken on the
+// way is stored in a fresh register, one per tag, numbered after the registers
+// of the source state.
+//
+// The ^ anchor is only crossed by the initial closure. Past a $ anchor, the
+// input must end, and only the accepting states are kept; the states are
+// visited apart on either side of it.
+//
+struct tdfa_closure_t {
+    tdfa_closure_t (const nfa_t& nfa)
+        : nfa (nfa), kernel (nfa.states.size ()), accepting (kernel.size ()),
+          visited (2 * kernel.size ()), fresh (), initial () {
+        for (size_t i = 0; i < nfa.states.size (); ++i)
+            kernel [i] = any_of (
+                nfa.states [i].begin (), nfa.states [i].end (),
+                [](const auto& t) { return nfa_t::is_symbol (t.first); });
+
+        for (const auto s : nfa.accept)
+            kernel [s] = accepting [s] = true;
+    }
+
+    tdfa_kernel_t
+    operator() (const tdfa_kernel_t& reach, size_t n, bool first = false) {
+        fresh = n;
+        initial = first;
+
+        fill (visited.begin (), visited.end (), false);
+        result.clear ();
+
+        for (const auto& x : reach)
+            visit (x.state, x.regs, false);
+
+        return move (result);
+    }
+
+    void visit (size_t s, const vector< tdfa_register_t >& regs, bool end) {
+        auto&& x = visited [2 * s + end];
+
+        if (x)
+            return;
+
+        x = true;
+
+        if (end ? accepting [s] : kernel [s])
+            result.push_back ({ s, regs });
+
+        for (const auto& t : nfa.states [s]) {
+            if (nfa_t::epsilon == t.first)
+                visit (t.second, regs, end);
+            else if (nfa_t::is_epsilon (t.first)) {
+                const size_t i = nfa_t::epsilon - 1 - t.first;
+                assert (i < regs.size ());
+
+                auto other = regs;
+                other [i] = tdfa_register_t (fresh + i);
+
+                visit (t.second, other, end);
+            }
+            else if (nfa_t::begin_anchor == t.first && initial)
+                visit (t.second, regs, end);
+            else if (nfa_t::end_anchor == t.first)
+                visit (t.second, regs, true);
+        }
+    }
+
+    const nfa_t& nfa;
+
+    vector< bool > kernel, accepting, visited;
+
+    size_t fresh;
+    bool initial;
+
+    tdfa_kernel_t result;
+};
+
+//
+// The kernel with its registers renumbered in the order of their first use:
+// kernels that differ only by a renaming of their registers coincide.
+//
+static tdfa_kernel_t
+tdfa_canonical (tdfa_kernel_t kernel) {
+    map< tdfa_register_t, tdfa_register_t > rename;
+
+    for (auto& x : kernel)
+        for (auto& r : x.regs)
+            r = rename.emplace (
+                r, tdfa_register_t (rename.size ())).first->second;
+
+    return kernel;
+}
+
+//
+// Register allocation for a new state: the registers of the source state keep
+// their numbers, so that the transition that creates the state copies none,
+// and the fresh ones, from n on, take the lowest numbers left free. Returns the
+// number of registers the state spans.
+//
+static size_t
+tdfa_allocate (tdfa_kernel_t& kernel, size_t n, size_t tags) {
+    vector< bool > used (n);
+
+    for (const auto& x : kernel)
+        for (const auto r : x.regs)
+            if (r < n)
+                used [r] = true;
+
+    vector< tdfa_register_t > fresh (tags, tdfa_t::position);
+
+    size_t next = 0, count = 0;
+
+    for (auto& x : kernel)
+        for (auto& r : x.regs) {
+            if (r >= n) {
+                auto& y = fresh [r - n];
+
+                if (tdfa_t::position == y) {
+                    for (; next < n && used [next]; ++next) ;
+                    y = tdfa_register_t (next++);
+                }
+
+                r = y;
+            }
+
+            count = (max) (count, size_t (r) + 1);
+        }
+
+    return count;
+}
+
+//
+// The operations that move the values of the registers of a kernel to those
+// of the state it maps to, stores of the current position for the fresh ones:
+//
+static vector< tdfa_op_t >
+tdfa_moves (const tdfa_kernel_t& from, const tdfa_kernel_t& to, size_t n) {
+    assert (from.size () == to.size ());
+
+    vector< tdfa_op_t > copies, stores;
+    vector< bool > done;
+
+    for (size_t i = 0; i < from.size (); ++i)
+        for (size_t j = 0; j < from [i].regs.size (); ++j) {
+            const auto a = from [i].regs [j], b = to [i].regs [j];
+
+            if (done.size () <= b)
+                done.resize (b + 1);
+
+            if (done [b])
+                continue;
+
+            done [b] = true;
+
+            if (a >= n)
+                stores.emplace_back (b, tdfa_t::position);
+            else if (a != b)
+                copies.emplace_back (b, a);
+        }
+
+    //
+    // The copies are a parallel assignment: a copy goes once its destination
+    // is no longer the source of a pending one, a cycle is broken by saving
+    // one destination in the scratch register. Stores read no register and go
+    // last:
+    //
+    vector< tdfa_op_t > ops;
+
+    for (; !copies.empty ();) {
+        const auto ready = [&](const auto& x) {
+            return none_of (copies.begin (), copies.end (), [&](const auto& y) {
+                    return y.second == x.first;
+                });
+        };
+
+        auto iter = find_if (copies.begin (), copies.end (), ready);
+
+        if (iter == copies.end ()) {
+            const auto r = copies.front ().first;
+            ops.emplace_back (tdfa_scratch, r);
+
+            for (auto& y : copies)
+                if (y.second == r)
+                    y.second = tdfa_scratch;
+
+            continue;
+        }
+
+        ops.push_back (*iter);
+        copies.erase (iter);
+    }
+
+    ops.insert (ops.end (), stores.begin (), stores.end ());
+
+    return ops;
+}
+
+using tdfa_transition_t = tuple< int, size_t, vector< tdfa_op_t > >;
+
+//
+// The registers live before the operations, given those live after them, and
+// the operations without the ones whose destination is dead:
+//
+static vector< bool >
+tdfa_live_before (vector< tdfa_op_t >& ops, vector< bool > live, bool drop) {
+    vector< tdfa_op_t > kept;
+
+    for (auto iter = ops.rbegin (); iter != ops.rend (); ++iter) {
+        if (!live [iter->first])
+            continue;
+
+        live [iter->first] = false;
+
+        if (tdfa_t::position != iter->second)
+            live [iter->second] = true;
+
+        kept.push_back (*iter);
+    }
+
+    if (drop)
+        ops.assign (kept.rbegin (), kept.rend ());
+
+    return live;
+}
+
+//
+// A register is live on entry to a state when it holds a tag of the state, if
+// accepting, or is live before the operations of one of its transitions. Once
+// the liveness is settled, the operations on dead registers, most of the
+// stores of positions that later ones overwrite, are dropped:
+//
+static void
+tdfa_eliminate_dead_ops (
+    tdfa_t& tdfa, vector< vector< tdfa_transition_t > >& transitions) {
+    const auto n = transitions.size ();
+
+    vector< vector< bool > > live (n, vector< bool > (tdfa.registers));
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto r : tdfa.final [i])
+            live [i][r] = true;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (size_t i = n; i-- > 0;)
+            for (auto& t : transitions [i]) {
+                const auto v = tdfa_live_before (
+                    get< 2 > (t), live [get< 1 > (t)], false);
+
+                for (size_t r = 0; r < v.size (); ++r)
+                    if (v [r] && !live [i][r])
+                        changed = live [i][r] = true;
+            }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        for (auto& t : transitions [i])
+            tdfa_live_before (get< 2 > (t), live [get< 1 > (t)], true);
+
+    tdfa_live_before (tdfa.initial, live [tdfa.start], true);
+}
+
+} // namespace detail
+
+tdfa_t
+make_tdfa (const nfa_t& nfa, size_t tags) {
+    using namespace detail;
+
+    using key_type = pair< vector< size_t >, vector< tdfa_register_t > >;
+
+    const auto key_of = [&](const tdfa_kernel_t& kernel) {
+        key_type key;
+
+        for (const auto& x : kernel) {
+            key.first.push_back (x.state);
+            key.second.insert (
+                key.second.end (), x.regs.begin (), x.regs.end ());
+        }
+
+        return key;
+    };
+
+    vector< bool > accepting (nfa.states.size ());
+
+    for (const auto s : nfa.accept)
+        accepting [s] = true;
+
+    tdfa_closure_t closure (nfa);
+
+    map< key_type, size_t > ids;
+
+    //
+    // Kernels and their register counts, and the transitions of every state as
+    // the symbol, the target and the operations:
+    //
+    vector< tdfa_kernel_t > kernels;
+    vector< size_t > counts;
+
+    vector< vector< tdfa_transition_t > > transitions;
+
+    size_t registers = 1;
+    bool scratch = false;
+
+    const auto intern = [&](const tdfa_kernel_t& kernel, size_t n,
+                            vector< tdfa_op_t >& ops) {
+        const auto key = key_of (tdfa_canonical (kernel));
+
+        auto iter = ids.find (key);
+
+        if (iter == ids.end ()) {
+            auto target = kernel;
+
+            const auto count = tdfa_allocate (target, n, tags);
+            registers = (max) (registers, count);
+
+            iter = ids.emplace (key, kernels.size ()).first;
+
+            kernels.push_back (move (target));
+            counts.push_back (count);
+
+            transitions.emplace_back ();
+        }
+
+        ops = tdfa_moves (kernel, kernels [iter->second], n);
+
+        for (const auto& op : ops)
+            scratch = scratch || tdfa_scratch == op.first;
+
+        return iter->second;
+    };
+
+    tdfa_t tdfa;
+    tdfa.tags = tags;
+
+    //
+    // The initial kernel starts from one register, holding -1 for all tags
+    // still unset:
+    //
+    tdfa.start = tdfa_t::size_type (intern (
+        closure (
+            { { nfa.start, vector< tdfa_register_t > (tags, 0) } }, 1, true),
+        1, tdfa.initial));
+
+    for (size_t i = 0; i < kernels.size (); ++i) {
+        map< int, tdfa_kernel_t > reach;
+
+        for (const auto& x : kernels [i])
+            for (const auto& t : nfa.states [x.state])
+                if (nfa_t::is_symbol (t.first))
+                    reach [t.first].push_back ({ t.second, x.regs });
+
+        for (auto& r : reach) {
+            auto kernel = closure (r.second, counts [i]);
+
+            if (kernel.empty ())
+                continue;
+
+            vector< tdfa_op_t > ops;
+            const auto to = intern (kernel, counts [i], ops);
+
+            transitions [i].emplace_back (r.first, to, move (ops));
+        }
+    }
+
+    //
+    // The scratch register, if any, goes after the others:
+    //
+    const auto n = kernels.size ();
+
+    tdfa.registers = registers + scratch;
+    tdfa.dead = tdfa_t::size_type (n);
+
+    const auto fix = [&](vector< tdfa_op_t >& ops) {
+        for (auto& op : ops) {
+            if (tdfa_scratch == op.first)
+                op.first = tdfa_t::size_type (registers);
+
+            if (tdfa_scratch == op.second)
+                op.second = tdfa_t::size_type (registers);
+        }
+    };
+
+    fix (tdfa.initial);
+
+    for (auto& ts : transitions)
+        for (auto& t : ts)
+            fix (get< 2 > (t));
+
+    //
+    // In an accepting state, the tags are those of the first accepting NFA
+    // state, on the path of highest priority:
+    //
+    tdfa.final.resize (n + 1);
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& x : kernels [i])
+            if (accepting [x.state]) {
+                tdfa.final [i].assign (x.regs.begin (), x.regs.end ());
+                break;
+            }
+
+    tdfa_eliminate_dead_ops (tdfa, transitions);
+
+    tdfa.next.assign ((n + 1) * tdfa_t::width, tdfa.dead);
+    tdfa.action.assign ((n + 1) * tdfa_t::width, 0);
+
+    tdfa.actions.emplace_back ();
+
+    map< vector< tdfa_op_t >, tdfa_t::size_type > actions { { { }, 0 } };
+
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& t : transitions [i]) {
+            const auto c = get< 0 > (t);
+            assert (0 <= c && size_t (c) < tdfa_t::width);
+
+            const auto& ops = get< 2 > (t);
+
+            auto iter = actions.find (ops);
+
+            if (iter == actions.end ()) {
+                iter = actions.emplace (
+                    ops, tdfa_t::size_type (tdfa.actions.size ())).first;
+                tdfa.actions.push_back (ops);
+            }
+
+            const auto j = i * tdfa_t::width + c;
+
+            tdfa.next [j] = tdfa_t::size_type (get< 1 > (t));
+            tdfa.action [j] = iter->second;
+        }
+
+    return tdfa;
+}
+
+namespace detail {
+
+static inline void
+tdfa_apply (const vector< tdfa_op_t >& ops, vector< ptrdiff_t >& regs,
+            ptrdiff_t pos) {
+    for (const auto& op : ops)
+        regs [op.first] =
+            tdfa_t::position == op.second ? pos : regs [op.second];
+}
+
+} // namespace detail
+
+bool
+match (const tdfa_t& tdfa, const char* first, const char* last,
+       captures_t& captures) {
+    vector< ptrdiff_t > regs;
+    return match (tdfa, first, last, captures, regs);
+}
+
+bool
+match (const tdfa_t& tdfa, const char* first, const char* last,
+       captures_t& captures, vector< ptrdiff_t >& regs) {
+    regs.assign (tdfa.registers, -1);
+
+    detail::tdfa_apply (tdfa.initial, regs, 0);
+
+    auto s = tdfa.start;
+
+    for (const char* p = first; p != last; ++p) {
+        const size_t i = size_t (s) * tdfa_t::width + (unsigned char)*p;
+
+        s = tdfa.next [i];
+
+        if (tdfa.dead == s)
+            return false;
+
+        if (const auto a = tdfa.action [i])
+            detail::tdfa_apply (tdfa.actions [a], regs, p - first + 1);
+    }
+
+    const auto& final = tdfa.final [s];
+
+    if (final.empty ())
+        return false;
+
+    captures.resize (tdfa.tags / 2);
+
+    for (size_t i = 0; i < captures.size (); ++i)
+        captures [i] = { regs [final [2 * i]], regs [final [2 * i + 1]] };
+
+    return true;
+}
@@ -0,0 +1,117 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <vector>
+
+using namespace std;
+
+#include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+
+dfa_t
+trim (const dfa_t& src) {
+    const auto n = src.states.size ();
+
+    //
+    // As a bounded make_dfa leaves it when it fails:
+    //
+    if (0 == n)
+        return src;
+
+    vector< bool > reachable (n), live (n);
+
+    {
+        vector< size_t > st { src.start };
+        reachable [src.start] = true;
+
+        while (!st.empty ()) {
+            const auto s = st.back ();
+            st.pop_back ();
+
+            for (const auto& t : src.states [s])
+                if (!reachable [t.second]) {
+                    reachable [t.second] = true;
+                    st.push_back (t.second);
+                }
+        }
+    }
+
+    {
+        vector< vector< size_t > > sources (n);
+
+        for (size_t i = 0; i < n; ++i)
+            if (reachable [i])
+                for (const auto& t : src.states [i])
+                    sources [t.second].push_back (i);
+
+        vector< size_t > st;
+
+        for (const auto s : src.accept)
+            if (reachable [s] && !live [s]) {
+                live [s] = true;
+                st.push_back (s);
+            }
+
+        while (!st.empty ()) {
+            const auto s = st.back ();
+            st.pop_back ();
+
+            for (const auto p : sources [s])
+                if (!live [p]) {
+                    live [p] = true;
+                    st.push_back (p);
+                }
+        }
+    }
+
+    size_t unreachable = 0, dead = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (i == src.start)
+            continue;
+
+        if (!reachable [i])
+            ++unreachable;
+        else if (!live [i])
+            ++dead;
+    }
+
+    RETA_STATS_UPDATE ({
+            stats.trimmed_unreachable += unreachable;
+            stats.trimmed_dead += dead;
+        });
+
+    if (0 == unreachable + dead)
+        return src;
+
+    live [src.start] = true;
+
+    vector< size_t > number (n, size_t (-1));
+    size_t k = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        if (live [i])
+            number [i] = k++;
+
+    dfa_t dst { };
+    dst.states.resize (k);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!live [i])
+            continue;
+
+        for (const auto& t : src.states [i])
+            if (live [t.second])
+                dst.states [number [i]].emplace_back (
+                    t.first, number [t.second]);
+    }
+
+    for (const auto s : src.accept)
+        if (live [s])
+            dst.accept.push_back (number [s]);
+
+    dst.start = number [src.start];
+
+    return dst;
+}
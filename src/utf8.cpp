@@ -0,0 +1,189 @@
+// -*- mode: c++; -*-
+
+#include <cassert>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/utf8.hpp>
+
+void
+canonicalize (code_point_ranges_t& ranges) {
+    sort (ranges.begin (), ranges.end ());
+
+    code_point_ranges_t result;
+
+    for (const auto& r : ranges) {
+        assert (r.first <= r.second);
+
+        if (!result.empty () && r.first <= result.back ().second + 1)
+            result.back ().second = (max) (result.back ().second, r.second);
+        else
+            result.push_back (r);
+    }
+
+    ranges = move (result);
+}
+
+code_point_ranges_t
+complement (const code_point_ranges_t& ranges) {
+    code_point_ranges_t result;
+
+    uint32_t next = 0;
+
+    for (const auto& r : ranges) {
+        if (next < r.first)
+            result.emplace_back (next, r.first - 1);
+
+        next = r.second + 1;
+    }
+
+    if (next <= max_code_point)
+        result.emplace_back (next, max_code_point);
+
+    return result;
+}
+
+string
+encode_utf8 (uint32_t c) {
+    assert (c <= max_code_point);
+
+    string s;
+
+    if (c < 0x80)
+        s += char (c);
+    else if (c < 0x800) {
+        s += char (0xc0 | (c >> 6));
+        s += char (0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000) {
+        s += char (0xe0 | (c >> 12));
+        s += char (0x80 | ((c >> 6) & 0x3f));
+        s += char (0x80 | (c & 0x3f));
+    }
+    else {
+        s += char (0xf0 | (c >> 18));
+        s += char (0x80 | ((c >> 12) & 0x3f));
+        s += char (0x80 | ((c >> 6) & 0x3f));
+        s += char (0x80 | (c & 0x3f));
+    }
+
+    return s;
+}
+
+bool
+decode_utf8 (const char*& first, const char* last, uint32_t& c) {
+    if (first == last)
+        return false;
+
+    const auto b = uint8_t (*first);
+
+    size_t n;
+
+    if (b < 0x80)
+        n = 0, c = b;
+    else if (0xc0 == (b & 0xe0))
+        n = 1, c = b & 0x1f;
+    else if (0xe0 == (b & 0xf0))
+        n = 2, c = b & 0x0f;
+    else if (0xf0 == (b & 0xf8))
+        n = 3, c = b & 0x07;
+    else
+        return false;
+
+    if (size_t (last - first) <= n)
+        return false;
+
+    for (size_t i = 1; i <= n; ++i) {
+        const auto x = uint8_t (first [i]);
+
+        if (0x80 != (x & 0xc0))
+            return false;
+
+        c = (c << 6) | (x & 0x3f);
+    }
+
+    static const uint32_t least [] = { 0, 0x80, 0x800, 0x10000 };
+
+    if (c < least [n] || c > max_code_point || (0xd800 <= c && c <= 0xdfff))
+        return false;
+
+    first += n + 1;
+
+    return true;
+}
+
+namespace detail {
+
+//
+// Splits the range until its ends encode to the same length and differ only
+// in their last bytes, or in bytes past which all continuation bytes are
+// taken, when the encodings of its ends bound every byte:
+//
+static void
+utf8_split (uint32_t lo, uint32_t hi, vector< utf8_sequence_t >& result) {
+    if (lo > hi)
+        return;
+
+    if (lo <= 0xdfff && 0xd800 <= hi) {
+        if (lo < 0xd800)
+            utf8_split (lo, 0xd7ff, result);
+
+        if (hi > 0xdfff)
+            utf8_split (0xe000, hi, result);
+
+        return;
+    }
+
+    for (const uint32_t x : { 0x7f, 0x7ff, 0xffff }) {
+        if (lo <= x && x < hi) {
+            utf8_split (lo, x, result);
+            utf8_split (x + 1, hi, result);
+            return;
+        }
+    }
+
+    for (size_t i = 1; i < 4; ++i) {
+        const uint32_t m = (1U << (6 * i)) - 1;
+
+        if ((lo & ~m) == (hi & ~m))
+            continue;
+
+        if (lo & m) {
+            utf8_split (lo, lo | m, result);
+            utf8_split ((lo | m) + 1, hi, result);
+            return;
+        }
+
+        if ((hi & m) != m) {
+            utf8_split (lo, (hi & ~m) - 1, result);
+            utf8_split (hi & ~m, hi, result);
+            return;
+        }
+    }
+
+    const auto a = encode_utf8 (lo), b = encode_utf8 (hi);
+    assert (a.size () == b.size ());
+
+    utf8_sequence_t seq;
+
+    for (size_t i = 0; i < a.size (); ++i)
+        seq.emplace_back (uint8_t (a [i]), uint8_t (b [i]));
+
+    result.push_back (move (seq));
+}
+
+} // namespace detail
+
+vector< utf8_sequence_t >
+utf8_sequences (uint32_t lo, uint32_t hi) {
+    assert (lo <= hi && hi <= max_code_point);
+
+    vector< utf8_sequence_t > result;
+    detail::utf8_split (lo, hi, result);
+
+    return result;
+}
@@ -0,0 +1,146 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE aho_corasick
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/aho-corasick.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static string
+make_string (mt19937& gen, size_t first, size_t last, char hi) {
+    uniform_int_distribution< size_t > len (first, last);
+    uniform_int_distribution< int > c ('a', hi);
+
+    string s (len (gen), 0);
+
+    for (auto& x : s)
+        x = char (c (gen));
+
+    return s;
+}
+
+static bool
+naive_search (const vector< string >& literals, const string& s) {
+    return any_of (literals.begin (), literals.end (), [&](const auto& x) {
+            return string::npos != s.find (x);
+        });
+}
+
+BOOST_AUTO_TEST_SUITE(aho_corasick)
+
+BOOST_AUTO_TEST_CASE (aho_corasick_literals_of) {
+    vector< string > v;
+
+    BOOST_TEST (literals_of (postfix ("foo|bar|baz"), v));
+    BOOST_TEST (v == (vector< string > { "bar", "baz", "foo" }));
+
+    BOOST_TEST (literals_of (postfix ("(a|b)(c|d)|ac"), v));
+    BOOST_TEST (v == (vector< string > { "ac", "ad", "bc", "bd" }));
+
+    BOOST_TEST (literals_of (postfix ("(foo)|(bar)"), v));
+    BOOST_TEST (v.size () == 2U);
+
+    BOOST_TEST (!literals_of (postfix ("fo*|bar"), v));
+    BOOST_TEST (!literals_of (postfix ("(ab)*"), v));
+
+    //
+    // 2^10 strings, over a bound of 512:
+    //
+    string r;
+
+    for (size_t i = 0; i < 10; ++i)
+        r += "(a|b)";
+
+    BOOST_TEST (literals_of (postfix (r), v));
+    BOOST_TEST (v.size () == 1024U);
+
+    BOOST_TEST (!literals_of (postfix (r), v, 512));
+}
+
+BOOST_AUTO_TEST_CASE (aho_corasick_match) {
+    mt19937 gen (1);
+
+    for (size_t n : { 1, 5, 50, 500 }) {
+        vector< string > literals;
+
+        for (size_t i = 0; i < n; ++i)
+            literals.push_back (make_string (gen, 1, 8, 'd'));
+
+        string r;
+
+        for (const auto& s : literals)
+            r += (r.empty () ? "" : "|") + s;
+
+        const auto dfa = minimize_dfa (make_dfa (make_nfa (postfix (r))));
+        const aho_corasick_t ac (literals);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            const auto s = make_string (gen, 0, 9, 'd');
+            const auto first = s.data (), last = first + s.size ();
+
+            BOOST_TEST (match (ac, first, last) == match (dfa, first, last));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (aho_corasick_search) {
+    mt19937 gen (2);
+
+    //
+    // Set sizes on either side of the prefilter bound, and literals as short
+    // as one byte, which narrows the fingerprint:
+    //
+    for (size_t n : { 1, 3, 8, 16, 17, 64, 300 })
+        for (size_t shortest : { 1, 2, 3, 6 }) {
+            vector< string > literals;
+
+            for (size_t i = 0; i < n; ++i)
+                literals.push_back (
+                    make_string (gen, shortest, i ? 8 : shortest, 'z'));
+
+            const aho_corasick_t ac (literals), plain (literals, false);
+
+            BOOST_TEST (!plain.prefilter ());
+
+            if (ac.prefilter ())
+                BOOST_TEST (ac.fingerprint == (min) (shortest, size_t (3)));
+
+            for (size_t i = 0; i < 200; ++i) {
+                const auto s = make_string (gen, 0, 200, 'z');
+                const auto first = s.data (), last = first + s.size ();
+
+                const auto expected = naive_search (literals, s);
+
+                BOOST_TEST (search (ac, first, last) == expected);
+                BOOST_TEST (search (plain, first, last) == expected);
+            }
+        }
+}
+
+BOOST_AUTO_TEST_CASE (aho_corasick_search_overlaps) {
+    //
+    // Occurrences found only through the failure links, and one straddling
+    // the last block of the prefilter:
+    //
+    const vector< string > literals { "he", "she", "his", "hers" };
+    const aho_corasick_t ac (literals);
+
+    for (const string s : { "ushers", "ahishe", "xxxxxxxxxxxxxxxxxxxhe",
+                "xxxxxxxxxxxxxxxxhxrs", "xxxxxxxxxxxxxxxhi" }) {
+        const auto first = s.data (), last = first + s.size ();
+        BOOST_TEST (search (ac, first, last) == naive_search (literals, s));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,213 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE captures
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/tdfa.hpp>
+
+#include "generators.hpp"
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static tdfa_t
+make_tdfa (const string& r) {
+    size_t groups = 0;
+    const auto nfa = make_nfa (postfix_captures (r, &groups));
+
+    return make_tdfa (nfa, 2 * groups);
+}
+
+static captures_t
+captures_of (const tdfa_t& tdfa, const string& s) {
+    captures_t captures;
+
+    if (!match (tdfa, s.data (), s.data () + s.size (), captures))
+        captures.clear ();
+
+    return captures;
+}
+
+//
+// The reference: a backtracking search of the tagged NFA, through the
+// transitions in their order, the first path that accepts at the end of the
+// input winning. A state is not entered twice at the same position, the first
+// visit having had the higher priority.
+//
+struct backtrack_t {
+    backtrack_t (const nfa_t& nfa, const string& s, size_t tags)
+        : nfa (nfa), s (s), tags (tags, -1),
+          seen (nfa.states.size () * (s.size () + 1)) { }
+
+    bool operator() (size_t q, size_t pos) {
+        auto&& x = seen [q * (s.size () + 1) + pos];
+
+        if (x)
+            return false;
+
+        x = true;
+
+        if (pos == s.size () && count (
+                nfa.accept.begin (), nfa.accept.end (), q))
+            return true;
+
+        for (const auto& t : nfa.states [q]) {
+            if (nfa_t::epsilon == t.first) {
+                if ((*this) (t.second, pos))
+                    return true;
+            }
+            else if (nfa_t::is_epsilon (t.first)) {
+                auto& tag = tags [nfa_t::epsilon - 1 - t.first];
+
+                const auto saved = tag;
+                tag = ptrdiff_t (pos);
+
+                if ((*this) (t.second, pos))
+                    return true;
+
+                tag = saved;
+            }
+            else if (pos < s.size () && t.first == s [pos]) {
+                if ((*this) (t.second, pos + 1))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    const nfa_t& nfa;
+    const string& s;
+
+    vector< ptrdiff_t > tags;
+    vector< bool > seen;
+};
+
+static captures_t
+backtrack (const string& r, const string& s) {
+    size_t groups = 0;
+    const auto nfa = make_nfa (postfix_captures (r, &groups));
+
+    backtrack_t b (nfa, s, 2 * groups);
+
+    captures_t captures;
+
+    if (b (nfa.start, 0))
+        for (size_t i = 0; i < groups; ++i)
+            captures.emplace_back (b.tags [2 * i], b.tags [2 * i + 1]);
+
+    return captures;
+}
+
+BOOST_AUTO_TEST_SUITE(captures)
+
+BOOST_AUTO_TEST_CASE (captures_basics) {
+    using c = captures_t;
+
+    const auto t1 = make_tdfa ("(a*)(b*)");
+
+    BOOST_TEST ((captures_of (t1, "aab") ==
+                 c { { 0, 3 }, { 0, 2 }, { 2, 3 } }));
+    BOOST_TEST ((captures_of (t1, "") == c { { 0, 0 }, { 0, 0 }, { 0, 0 } }));
+    BOOST_TEST ((captures_of (t1, "ba") == c { }));
+
+    //
+    // Greedy: the first alternative, then as much as possible:
+    //
+    const auto t2 = make_tdfa ("(a|ab)(c|bcd)(d*)");
+
+    BOOST_TEST ((captures_of (t2, "abcd") ==
+                 c { { 0, 4 }, { 0, 1 }, { 1, 4 }, { 4, 4 } }));
+
+    const auto t3 = make_tdfa ("(a*)(a*)");
+
+    BOOST_TEST ((captures_of (t3, "aaa") ==
+                 c { { 0, 3 }, { 0, 3 }, { 3, 3 } }));
+
+    //
+    // The last iteration of a group in a closure, and a group that does not
+    // take part:
+    //
+    const auto t4 = make_tdfa ("((a)|(b))*");
+
+    BOOST_TEST ((captures_of (t4, "ab") ==
+                 c { { 0, 2 }, { 1, 2 }, { 0, 1 }, { 1, 2 } }));
+    BOOST_TEST ((captures_of (t4, "bb") ==
+                 c { { 0, 2 }, { 1, 2 }, { -1, -1 }, { 1, 2 } }));
+}
+
+BOOST_AUTO_TEST_CASE (captures_anchors) {
+    using c = captures_t;
+
+    const auto t1 = make_tdfa ("^(a*)(b*)$");
+
+    BOOST_TEST ((captures_of (t1, "aab") ==
+                 c { { 0, 3 }, { 0, 2 }, { 2, 3 } }));
+
+    //
+    // The first alternative only holds at the end of the input:
+    //
+    const auto t2 = make_tdfa ("(a$|a)(b*)");
+
+    BOOST_TEST ((captures_of (t2, "a") == c { { 0, 1 }, { 0, 1 }, { 1, 1 } }));
+    BOOST_TEST ((captures_of (t2, "ab") == c { { 0, 2 }, { 0, 1 }, { 1, 2 } }));
+
+    BOOST_TEST ((captures_of (make_tdfa ("a(^b)"), "ab") == c { }));
+}
+
+BOOST_AUTO_TEST_CASE (captures_language) {
+    mt19937 gen (1);
+
+    for (size_t i = 0; i < 200; ++i) {
+        const auto r = make_regex (gen, 4);
+
+        const auto dfa = make_dfa (make_nfa (postfix (r)));
+        const auto tagged = make_dfa (make_nfa (postfix_captures (r)));
+        const auto tdfa = make_tdfa (r);
+
+        for (size_t j = 0; j < 50; ++j) {
+            string s (gen () % 8, 0);
+
+            for (auto& x : s)
+                x = "ab" [gen () % 2];
+
+            const auto first = s.data (), last = first + s.size ();
+
+            const auto expected = match (dfa, first, last);
+
+            captures_t captures;
+
+            BOOST_TEST (match (tagged, first, last) == expected);
+            BOOST_TEST (match (tdfa, first, last, captures) == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (captures_backtracking) {
+    mt19937 gen (2);
+
+    for (size_t i = 0; i < 500; ++i) {
+        const auto r = make_regex (gen, 5);
+        const auto tdfa = make_tdfa (r);
+
+        for (size_t j = 0; j < 30; ++j) {
+            string s (gen () % 10, 0);
+
+            for (auto& x : s)
+                x = "ab" [gen () % 2];
+
+            BOOST_TEST ((captures_of (tdfa, s) == backtrack (r, s)),
+                        r << " on " << s);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
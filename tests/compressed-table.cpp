@@ -0,0 +1,76 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE compressed_table
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/compressed-table.hpp>
+
+#include "generators.hpp"
+
+#include <boost/format.hpp>
+using fmt = boost::format;
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(compressed_table)
+
+BOOST_AUTO_TEST_CASE (compressed_tables) {
+    const auto input = make_input ("abcdefx", 4);
+
+    for (const auto& r : table_patterns) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % r);
+
+        const auto dfa = minimize_dfa_table (make_dfa (make_nfa (postfix (r))));
+
+        const dense_table_t< uint8_t > dense8 (dfa);
+        const dense_table_t< uint32_t > dense32 (dfa);
+        const comb_table_t< uint8_t > comb8 (dfa);
+        const comb_table_t< uint16_t > comb16 (dfa);
+
+        for (const auto& s : input) {
+            const auto first = s.data (), last = first + s.size ();
+            const auto expected = match (dfa, first, last);
+
+            BOOST_TEST (expected == match (dense8, first, last));
+            BOOST_TEST (expected == match (dense32, first, last));
+            BOOST_TEST (expected == match (comb8, first, last));
+            BOOST_TEST (expected == match (comb16, first, last));
+
+            BOOST_TEST (expected == with_narrowest< comb_table_t > (
+                            dfa, [&](const auto& table) {
+                                return match (table, first, last);
+                            }));
+        }
+    }
+
+    //
+    // Past 255 states, and with input outside of the alphabet:
+    //
+    string r = "(a|b)*a";
+
+    for (size_t i = 0; i < 8; ++i)
+        r += "(a|b)";
+
+    const auto dfa = make_dfa (make_nfa (postfix (r)));
+    BOOST_TEST (dfa.states.size () > 255U);
+
+    const comb_table_t< uint16_t > comb (dfa);
+    BOOST_TEST (comb.bytes () < dense_table_t< uint16_t > (dfa).bytes () / 4);
+
+    for (const string s : {
+            "abbbbbbbb", "bbbbbbbbbbbbb", "aaaaaaaaaa", "aaaaa\xff" }) {
+        const auto first = s.data (), last = first + s.size ();
+        BOOST_TEST (match (dfa, first, last) == match (comb, first, last));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
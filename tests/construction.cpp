@@ -3,14 +3,26 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE construction
 
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace std;
 
 #include <reta/nfa.hpp>
 #include <reta/dfa.hpp>
+#include <reta/compiler.hpp>
+#include <reta/derivative.hpp>
 #include <reta/dot-graph.hpp>
+#include <reta/equivalence.hpp>
+#include <reta/product.hpp>
+#include <reta/table.hpp>
+
+#include "generators.hpp"
 
 #include <boost/format.hpp>
 using fmt = boost::format;
@@ -23,73 +35,73 @@ static const struct {
 } test_data [] = {
     { "a",
       "0 2 1 0 97 1 1 1 ",
-      "0 1 1 0 97 1 1 1 " },
+      "0 2 1 0 97 1 1 1 " },
     { "(a)",
       "0 2 1 0 97 1 1 1 ",
-      "0 1 1 0 97 1 1 1 " },
+      "0 2 1 0 97 1 1 1 " },
     { "(a*)",
-      "0 4 5 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 1 3 ",
+      "2 4 5 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 1 3 ",
       "0 2 2 0 97 1 1 97 1 2 0 1 " },
     { "ab",
       "0 4 3 0 97 1 1 -1 2 2 98 3 1 3 ",
-      "0 2 2 0 97 1 1 98 2 1 2 " },
+      "0 3 2 0 97 1 1 98 2 1 2 " },
     { "a|b",
-      "0 6 6 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 1 5 ",
-      "0 1 2 0 97 1 0 98 2 2 1 2 " },
+      "4 6 6 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 1 5 ",
+      "0 3 2 0 97 1 0 98 2 2 1 2 " },
     { "a*|b",
-      "0 8 10 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 7 4 98 5 5 -1 7 6 -1 2 6 "
+      "6 8 10 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 7 4 98 5 5 -1 7 6 -1 2 6 "
       "-1 4 1 7 ",
-      "0 2 3 0 97 1 0 98 2 1 97 1 3 0 1 2 " },
+      "0 3 3 0 97 1 0 98 2 1 97 1 3 0 1 2 " },
     { "a|b*",
-      "0 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
+      "6 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
       "-1 4 1 7 ",
-      "0 2 3 0 97 1 0 98 2 1 98 2 3 0 1 2 " },
+      "0 3 3 0 97 1 0 98 2 2 98 2 3 0 1 2 " },
     { "(a)|b*",
-      "0 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
+      "6 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
       "-1 4 1 7 ",
-      "0 2 3 0 97 1 0 98 2 1 98 2 3 0 1 2 " },
+      "0 3 3 0 97 1 0 98 2 2 98 2 3 0 1 2 " },
     { "(a|b)*",
-      "0 8 10 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 5 -1 4 5 -1 7 6 -1 4 6 "
+      "6 8 10 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 5 -1 4 5 -1 7 6 -1 4 6 "
       "-1 7 1 7 ",
       "0 3 6 0 97 1 0 98 2 1 97 1 1 98 2 2 97 1 2 98 2 3 0 1 2 " },
     { "a|(b)*",
-      "0 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
+      "6 8 10 0 97 1 1 -1 7 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 7 6 -1 0 6 "
       "-1 4 1 7 ",
-      "0 2 3 0 97 1 0 98 2 1 98 2 3 0 1 2 " },
+      "0 3 3 0 97 1 0 98 2 2 98 2 3 0 1 2 " },
     { "(a)|c",
-      "0 6 6 0 97 1 1 -1 5 2 99 3 3 -1 5 4 -1 0 4 -1 2 1 5 ",
-      "0 1 2 0 97 1 0 99 2 2 1 2 " },
+      "4 6 6 0 97 1 1 -1 5 2 99 3 3 -1 5 4 -1 0 4 -1 2 1 5 ",
+      "0 3 2 0 97 1 0 99 2 2 1 2 " },
     { "(a*)|c",
-      "0 8 10 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 7 4 99 5 5 -1 7 6 -1 2 6 "
+      "6 8 10 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 7 4 99 5 5 -1 7 6 -1 2 6 "
       "-1 4 1 7 ",
-      "0 2 3 0 97 1 0 99 2 1 97 1 3 0 1 2 " },
+      "0 3 3 0 97 1 0 99 2 1 97 1 3 0 1 2 " },
     { "ab|c",
-      "0 8 8 0 97 1 1 -1 2 2 98 3 3 -1 7 4 99 5 5 -1 7 6 -1 0 6 -1 4 1 7 ",
-      "0 2 3 0 97 1 0 99 2 1 98 3 2 2 3 " },
+      "6 8 8 0 97 1 1 -1 2 2 98 3 3 -1 7 4 99 5 5 -1 7 6 -1 0 6 -1 4 1 7 ",
+      "0 4 3 0 97 1 0 99 2 1 98 3 2 2 3 " },
     { "a|b|c",
-      "0 10 11 0 97 1 1 -1 9 2 98 3 3 -1 7 4 99 5 5 -1 7 6 -1 2 6 -1 4 7 -1 9 8 "
+      "8 10 11 0 97 1 1 -1 9 2 98 3 3 -1 7 4 99 5 5 -1 7 6 -1 2 6 -1 4 7 -1 9 8 "
       "-1 0 8 -1 6 1 9 ",
-      "0 1 3 0 97 1 0 98 2 0 99 3 3 1 2 3 " },
+      "0 4 3 0 97 1 0 98 2 0 99 3 3 1 2 3 " },
     { "a*|b|c",
-      "0 12 15 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 11 4 98 5 5 -1 9 6 99 7 7 "
+      "10 12 15 0 97 1 1 -1 0 1 -1 3 2 -1 0 2 -1 3 3 -1 11 4 98 5 5 -1 9 6 99 7 7 "
       "-1 9 8 -1 4 8 -1 6 9 -1 11 10 -1 2 10 -1 8 1 11 ",
-      "0 2 4 0 97 1 0 98 2 0 99 3 1 97 1 4 0 1 2 3 " },
+      "0 4 4 0 97 1 0 98 2 0 99 3 1 97 1 4 0 1 2 3 " },
     { "a|b*|c",
-      "0 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
+      "10 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
       "-1 9 8 -1 4 8 -1 6 9 -1 11 10 -1 0 10 -1 8 1 11 ",
-      "0 2 4 0 97 1 0 98 2 0 99 3 1 98 2 4 0 1 2 3 " },
+      "0 4 4 0 97 1 0 98 2 0 99 3 2 98 2 4 0 1 2 3 " },
     { "(a)|b*|c",
-      "0 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
+      "10 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
       "-1 9 8 -1 4 8 -1 6 9 -1 11 10 -1 0 10 -1 8 1 11 ",
-      "0 2 4 0 97 1 0 98 2 0 99 3 1 98 2 4 0 1 2 3 " },
+      "0 4 4 0 97 1 0 98 2 0 99 3 2 98 2 4 0 1 2 3 " },
     { "(a|b)*|c",
-      "0 12 15 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 5 -1 4 5 -1 7 6 -1 4 6 "
+      "10 12 15 0 97 1 1 -1 5 2 98 3 3 -1 5 4 -1 0 4 -1 2 5 -1 4 5 -1 7 6 -1 4 6 "
       "-1 7 7 -1 11 8 99 9 9 -1 11 10 -1 6 10 -1 8 1 11 ",
-      "0 3 7 0 97 1 0 98 2 0 99 3 1 97 1 1 98 2 2 97 1 2 98 2 4 0 1 2 3 " },
+      "0 4 7 0 97 1 0 98 2 0 99 3 1 97 1 1 98 2 2 97 1 2 98 2 4 0 1 2 3 " },
     { "a|(b)*|c",
-      "0 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
+      "10 12 15 0 97 1 1 -1 11 2 98 3 3 -1 2 3 -1 5 4 -1 2 4 -1 5 5 -1 9 6 99 7 7 "
       "-1 9 8 -1 4 8 -1 6 9 -1 11 10 -1 0 10 -1 8 1 11 ",
-      "0 2 4 0 97 1 0 98 2 0 99 3 1 98 2 4 0 1 2 3 " }
+      "0 4 4 0 97 1 0 98 2 0 99 3 2 98 2 4 0 1 2 3 " }
 };
 
 BOOST_AUTO_TEST_SUITE(construction)
@@ -120,4 +132,531 @@ BOOST_AUTO_TEST_CASE (construction_from_regex) {
     }
 }
 
+//
+// Malformed expressions are reported, by each of the passes that take them:
+//
+BOOST_AUTO_TEST_CASE (construction_errors) {
+    for (const string r : {
+            "", "a[", "ab)", "*a", "a||b", "|a", "a|", "()", "(a|)", "(a",
+            "a(b", "a.b", "aB", "a 1" }) {
+        BOOST_CHECK_THROW (postfix (r), invalid_argument);
+        BOOST_CHECK_THROW (postfix_captures (r), invalid_argument);
+        BOOST_CHECK_THROW (compiler_t ().compile (r), invalid_argument);
+    }
+
+    BOOST_CHECK_NO_THROW (postfix ("(a|^)*b$"));
+    BOOST_CHECK_NO_THROW (postfix_captures ("((a)|(b))*"));
+
+    //
+    // Classes, only the Thompson construction takes:
+    //
+    for (const string r : { "[ab]", "a\\p{L}*" }) {
+        const auto s = postfix (r);
+
+        BOOST_CHECK_NO_THROW (make_nfa (s, construction_t::thompson));
+        BOOST_CHECK_THROW (
+            make_nfa (s, construction_t::glushkov), invalid_argument);
+        BOOST_CHECK_THROW (make_derivative_dfa (s), invalid_argument);
+    }
+}
+
+//
+// (a|b)*a(a|b){n}, for which make_dfa produces 2^(n+1) + 1 states:
+//
+static string
+make_explosive (size_t n) {
+    string s = "(a|b)*a";
+
+    for (size_t i = 0; i < n; ++i)
+        s += "(a|b)";
+
+    return s;
+}
+
+//
+// The compact automata print as the others do, and read back; the narrowest
+// DFA matches as the one it comes from, past 255 states too:
+//
+BOOST_AUTO_TEST_CASE (construction_compact) {
+    static_assert (4 == sizeof (compact_dfa_t< uint16_t >::states [0][0]), "");
+    static_assert (4 == sizeof (compact_nfa_t< uint16_t >::states [0][0]), "");
+
+    const auto text = [](const auto& a) {
+        stringstream ss;
+        ss << a;
+
+        return ss.str ();
+    };
+
+    for (const auto& t : test_data) {
+        const auto nfa = automaton_cast< compact_nfa_t< uint16_t > > (
+            make_nfa (postfix (t.r)));
+
+        BOOST_TEST (text (nfa) == t.nfa);
+
+        const auto dfa = automaton_cast< compact_dfa_t< uint8_t > > (
+            make_dfa (make_nfa (postfix (t.r))));
+
+        BOOST_TEST (text (dfa) == t.dfa);
+
+        compact_dfa_t< uint8_t > other;
+
+        stringstream ss (t.dfa);
+        ss >> other;
+
+        BOOST_TEST (text (other) == t.dfa);
+
+        compact_nfa_t< uint8_t > narrow;
+
+        stringstream nfa_ss (t.nfa);
+        nfa_ss >> narrow;
+
+        BOOST_TEST (text (narrow) == t.nfa);
+        for (const string x : { "", "a", "ab", "abc", "bbb" }) {
+            const auto first = x.data (), last = first + x.size ();
+            BOOST_TEST (match (narrow, first, last) == match (nfa, first, last));
+        }
+    }
+
+    mt19937 gen (13);
+
+    for (const auto n : { 2, 9 }) {
+        const auto dfa = minimize_dfa (make_dfa (make_nfa (postfix (
+            make_explosive (n)))));
+
+        const auto nfa = automaton_cast< compact_nfa_t< uint32_t > > (
+            make_nfa (postfix (make_explosive (n))));
+
+        for (size_t i = 0; i < 100; ++i) {
+            string s (gen () % 32, 0);
+
+            for (auto& c : s)
+                c = "ab" [gen () % 2];
+
+            const auto first = s.data (), last = first + s.size ();
+            const auto expected = match (dfa, first, last);
+
+            BOOST_TEST (expected == with_compact (dfa, [&](const auto& a) {
+                        return match (a, first, last);
+                    }));
+
+            BOOST_TEST (expected == match (nfa, first, last));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_budget) {
+    const auto nfa = make_nfa (postfix (make_explosive (12)));
+
+    {
+        dfa_options_t options;
+        options.max_states = 100;
+
+        dfa_t dfa;
+        BOOST_TEST (dfa_status_t::state_limit == make_dfa (nfa, options, dfa));
+        BOOST_TEST (dfa.states.empty ());
+    }
+
+    {
+        dfa_options_t options;
+        options.max_bytes = 4096;
+
+        dfa_t dfa;
+        BOOST_TEST (dfa_status_t::memory_limit == make_dfa (nfa, options, dfa));
+    }
+
+    {
+        dfa_options_t options;
+        options.deadline = dfa_options_t::clock_type::now ();
+
+        dfa_t dfa;
+        BOOST_TEST (dfa_status_t::deadline == make_dfa (nfa, options, dfa));
+    }
+
+    {
+        dfa_options_t options;
+        options.max_states = (1 << 13) + 1;
+
+        dfa_t dfa;
+        BOOST_TEST (dfa_status_t::ok == make_dfa (nfa, options, dfa));
+        BOOST_TEST (dfa.states.size () == options.max_states);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_nfa_fallback) {
+    const auto nfa = make_nfa (postfix (make_explosive (3)));
+    const auto dfa = make_dfa (nfa);
+
+    for (const string s : {
+            "", "a", "aaaa", "abbb", "babab", "bbbbb", "aaabbbb", "ababa" }) {
+        const auto first = s.data (), last = first + s.size ();
+        BOOST_TEST (match (dfa, first, last) == match (nfa, first, last));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_glushkov) {
+    for (const auto& t : test_data) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % t.r);
+
+        const auto s = postfix (t.r);
+
+        const auto thompson = make_nfa (s, construction_t::thompson);
+        const auto glushkov = make_nfa (s, construction_t::glushkov);
+
+        const auto literals = count_if (s.begin (), s.end (), [](auto c) {
+                return 'a' <= c && c <= 'z';
+            });
+
+        BOOST_TEST (glushkov.states.size () == size_t (literals) + 1);
+
+        for (const auto& ts : glushkov.states)
+            for (const auto& t : ts)
+                BOOST_TEST (t.first != nfa_t::epsilon);
+
+        BOOST_TEST (
+            minimize_dfa_table (make_dfa (glushkov)).states.size () ==
+            minimize_dfa_table (make_dfa (thompson)).states.size ());
+
+        for (const string x : { "", "a", "b", "c", "ab", "ba", "aab", "abab" }) {
+            const auto first = x.data (), last = first + x.size ();
+
+            BOOST_TEST (
+                match (thompson, first, last) == match (glushkov, first, last));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_derivatives) {
+    for (const auto& t : test_data) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % t.r);
+
+        const auto s = postfix (t.r);
+
+        const auto dfa = make_derivative_dfa (s);
+        const auto min = minimize_dfa_table (make_dfa (make_nfa (s)));
+
+        BOOST_TEST (dfa.states.size () == min.states.size ());
+
+        for (const string x : { "", "a", "b", "c", "ab", "ba", "aab", "abab" }) {
+            const auto first = x.data (), last = first + x.size ();
+            BOOST_TEST (match (dfa, first, last) == match (min, first, last));
+        }
+    }
+
+    //
+    // The anchors, ^ resolved at the start and $ at the end, as the subset
+    // construction follows them:
+    //
+    mt19937 gen (17);
+
+    const auto agree = [](const string& s) {
+        return equivalent (make_derivative_dfa (s), make_dfa (make_nfa (s)));
+    };
+
+    for (const string r : { "^a", "a$", "$^", "(a|$^)", "a*$^", "(^|a)*b$" })
+        BOOST_TEST (agree (postfix (r)), r);
+
+    for (size_t i = 0; i < 300; ++i) {
+        const auto r = make_regex (gen, 4, "abab^$");
+        BOOST_TEST (agree (postfix (r)), r);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_minimizers) {
+    vector< string > rs;
+
+    for (const auto& t : test_data)
+        rs.push_back (t.r);
+
+    rs.push_back (make_explosive (4));
+    rs.push_back ("abc|bbc|cbc|ab|b");
+    rs.push_back ("(ab|ba)*|(a|b)*b");
+
+    for (const auto& r : rs) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % r);
+
+        const auto dfa = make_dfa (make_nfa (postfix (r)));
+        const auto min = minimize_dfa_table (dfa);
+
+        for (const auto& other : {
+                minimize_dfa_hopcroft (dfa), minimize_dfa_brzozowski (dfa),
+                minimize_dfa (dfa) }) {
+            BOOST_TEST (other.states.size () == min.states.size ());
+            BOOST_TEST (other.accept.size () == min.accept.size ());
+
+            for (const string x : {
+                    "", "a", "b", "c", "ab", "ba", "bc", "aab", "abab", "abc",
+                    "bbc", "ababa", "abbbb" }) {
+                const auto first = x.data (), last = first + x.size ();
+                BOOST_TEST (match (other, first, last) == match (min, first, last));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (construction_product) {
+    static const vector< pair< string, string > > data {
+        { "(a|b)*a", "(a|b)*aa" },
+        { "a*b*", "(ab)*" },
+        { "abc|bbc|ab", "(a|b)*c" },
+        { "(a|b|c)*", "a" },
+        { "a", "b" }
+    };
+
+    const auto input = make_input ("abc", 5);
+
+    for (const auto& p : data) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1% and %2%") % p.first % p.second);
+
+        const auto a = make_dfa (make_nfa (postfix (p.first)));
+        const auto b = make_dfa (make_nfa (postfix (p.second)));
+
+        for (const auto minimize : { false, true }) {
+            const auto i = intersect (a, b, minimize);
+            const auto u = unite (a, b, minimize);
+            const auto d = difference (a, b, minimize);
+            const auto c = complement (a, minimize);
+
+            for (const auto& x : input) {
+                const auto first = x.data (), last = first + x.size ();
+
+                const auto ma = match (a, first, last);
+                const auto mb = match (b, first, last);
+
+                BOOST_TEST (match (i, first, last) == (ma && mb));
+                BOOST_TEST (match (u, first, last) == (ma || mb));
+                BOOST_TEST (match (d, first, last) == (ma && !mb));
+                BOOST_TEST (match (c, first, last) == !ma);
+            }
+
+            if (minimize)
+                BOOST_TEST (
+                    u.states.size () ==
+                    minimize_dfa (make_dfa (make_nfa (postfix (
+                        "(" + p.first + ")|(" + p.second + ")")))).states.size ());
+        }
+    }
+
+    //
+    // Over every byte, and without useless states:
+    //
+    const auto a = make_dfa (make_nfa (postfix ("a")));
+    const auto c = complement (a);
+
+    for (const string x : { "", "0", "\xff", "aa", "ab" }) {
+        const auto first = x.data (), last = first + x.size ();
+        BOOST_TEST (match (c, first, last));
+    }
+
+    BOOST_TEST (!match (c, "a", "a" + 1));
+
+    BOOST_TEST (intersect (a, c).states.size () == 1U);
+    BOOST_TEST (intersect (a, c).accept.empty ());
+}
+
+BOOST_AUTO_TEST_CASE (construction_equivalence) {
+    const auto dfa = [](const string& r) {
+        return make_dfa (make_nfa (postfix (r)));
+    };
+
+    //
+    // Equivalent, without being minimized first:
+    //
+    BOOST_TEST (equivalent (dfa ("(a|b)*"), dfa ("(a*b*)*")));
+    BOOST_TEST (equivalent (dfa ("(a|b)*a"), make_derivative_dfa (
+                    postfix ("(b*a)(b*a)*"))));
+
+    for (const auto& t : test_data) {
+        const auto a = dfa (t.r);
+        BOOST_TEST (equivalent (a, minimize_dfa (a)));
+    }
+
+    string s;
+
+    BOOST_TEST (!equivalent (dfa ("(a|b)*a"), dfa ("(a|b)*aa"), &s));
+    BOOST_TEST (s == "a");
+
+    BOOST_TEST (!equivalent (dfa ("abc|abd"), dfa ("ab(c|e)"), &s));
+    BOOST_TEST ((s == "abd" || s == "abe"));
+
+    BOOST_TEST (includes (dfa ("(a|b)*a"), dfa ("(a|b)*aa")));
+    BOOST_TEST (!includes (dfa ("(a|b)*aa"), dfa ("(a|b)*a"), &s));
+    BOOST_TEST (s == "a");
+
+    //
+    // As the union with the other is equivalent, the counterexample of b
+    // only, missing transitions of a included:
+    //
+    mt19937 gen (16);
+
+    for (size_t i = 0; i < 200; ++i) {
+        const auto a = dfa (make_regex (gen, 3, "abc"));
+        const auto b = dfa (make_regex (gen, 3, "abc"));
+
+        const auto expected = equivalent (a, unite (a, b));
+
+        BOOST_TEST (expected == includes (a, b, &s));
+
+        if (!expected) {
+            const auto first = s.data (), last = first + s.size ();
+            BOOST_TEST ((match (b, first, last) && !match (a, first, last)));
+        }
+    }
+
+    BOOST_TEST (includes (dfa ("a"), dfa_t { }));
+    BOOST_TEST (!includes (dfa_t { }, dfa ("a"), &s));
+    BOOST_TEST (s == "a");
+
+    BOOST_TEST (!accepts_nothing (dfa ("(a|b)*c(ab|c)"), &s));
+    BOOST_TEST (s == "cc");
+
+    BOOST_TEST (accepts_nothing (intersect (dfa ("a*"), dfa ("b(a|b)*"))));
+    BOOST_TEST (accepts_nothing (difference (dfa ("a*b"), dfa ("(a|b)*"))));
+}
+
+BOOST_AUTO_TEST_CASE (construction_trim) {
+    //
+    // 0 -a-> 1 (accepting), 0 -b-> 2 -a-> 2 (dead end), 3 -a-> 1 (unreachable):
+    //
+    dfa_t dfa { };
+
+    stringstream ss ("0 4 4 0 97 1 0 98 2 2 97 2 3 97 1 1 1 ");
+    ss >> dfa;
+
+    const auto t = trim (dfa);
+
+    {
+        stringstream ss;
+        ss << t;
+
+        BOOST_TEST (ss.str () == "0 2 1 0 97 1 1 1 ");
+    }
+
+    BOOST_TEST (minimize_dfa_table (dfa).states.size () == 2U);
+    BOOST_TEST (minimize_dfa (dfa).states.size () == 2U);
+
+    //
+    // The initial state stays, even if it accepts nothing:
+    //
+    dfa.accept.clear ();
+
+    BOOST_TEST (trim (dfa).states.size () == 1U);
+    BOOST_TEST (trim (dfa).states.front ().empty ());
+
+    BOOST_TEST (table_t (t).dead == dead_state (t));
+
+    //
+    // The output of a failed bounded construction:
+    //
+    const dfa_t empty { };
+
+    BOOST_TEST (trim (empty).states.empty ());
+    BOOST_TEST (minimize_dfa (empty).states.empty ());
+    BOOST_TEST (minimize_dfa_table (empty).states.empty ());
+}
+
+BOOST_AUTO_TEST_CASE (construction_derivatives_algebra) {
+    expressions_t e;
+
+    //
+    // Ending in a, but not in aa:
+    //
+    const auto a = e.parse (postfix ("(a|b)*a"));
+    const auto b = e.parse (postfix ("(a|b)*aa"));
+
+    const auto dfa = e.make_dfa (e.make_intersection (a, e.make_complement (b)));
+
+    for (const string x : { "a", "ba", "bba", "aba" }) {
+        const auto first = x.data (), last = first + x.size ();
+        BOOST_TEST (match (dfa, first, last));
+    }
+
+    for (const string x : { "", "aa", "b", "baa", "ab", "c" }) {
+        const auto first = x.data (), last = first + x.size ();
+        BOOST_TEST (!match (dfa, first, last));
+    }
+
+    //
+    // Anything but the empty string, over every byte:
+    //
+    const auto universe = e.make_dfa (e.make_complement (e.make_epsilon ()));
+
+    for (const string x : { "a", "0", "\xff", "zz" }) {
+        const auto first = x.data (), last = first + x.size ();
+        BOOST_TEST (match (universe, first, last));
+    }
+
+    BOOST_TEST (!match (universe, 0, 0));
+
+    BOOST_TEST (e.make_alternation (a, a) == a);
+    BOOST_TEST (e.make_alternation (a, b) == e.make_alternation (b, a));
+    BOOST_TEST (e.make_closure (e.make_closure (a)) == e.make_closure (a));
+}
+
+BOOST_AUTO_TEST_CASE (construction_simplify) {
+    const auto simplified = [](const string& r) {
+        return simplify (postfix (r));
+    };
+
+    BOOST_TEST (simplified ("abc|abd|abe") == postfix ("ab[c-e]"));
+    BOOST_TEST (simplified ("xay|xby|xaz") == postfix ("x(a[yz]|by)"));
+    BOOST_TEST (simplified ("abc|dbc") == postfix ("[ad]bc"));
+    BOOST_TEST (simplified ("a|b|a") == postfix ("[ab]"));
+    BOOST_TEST (simplified ("a|a") == postfix ("a"));
+    BOOST_TEST (simplified ("ab|a") == postfix ("ab|a"));
+
+    BOOST_TEST (simplified ("(a*)*") == postfix ("a*"));
+    BOOST_TEST (simplified ("((a*)*|b*)*") == postfix ("[ab]*"));
+    BOOST_TEST (simplified ("(ab|cd*)*") == postfix ("(ab|cd*)*"));
+
+    mt19937 gen (11);
+
+    for (size_t i = 0; i < 500; ++i) {
+        const auto s = postfix (make_regex (gen, 5, "abc"));
+        const auto t = simplify (s);
+
+        const auto a = make_nfa (s), b = make_nfa (t);
+
+        BOOST_TEST (equivalent (make_dfa (a), make_dfa (b)), s << " " << t);
+        BOOST_TEST (b.states.size () <= a.states.size (), s << " " << t);
+
+        BOOST_TEST (simplify (t) == t);
+    }
+}
+
+//
+// One compiler, and one output, through expressions of all sizes, anchors and
+// classes; the result is the minimal automaton of the pipeline:
+//
+BOOST_AUTO_TEST_CASE (construction_compiler) {
+    compiler_t compiler;
+    dfa_t dfa;
+
+    mt19937 gen (12);
+
+    vector< string > rs {
+        "^ab|c$", "(^a|b)*c", "a$|b", "^$", "[a-c]*\\p{Nd}", "ab*|[^a]", "a",
+        "$^", "a*$^", "(a|$^)*"
+    };
+
+    for (size_t i = 0; i < 500; ++i)
+        rs.push_back (make_regex (gen, i % 7, "abc"));
+
+    for (const auto& r : rs) {
+        compiler.compile (r, dfa);
+
+        const auto expected = minimize_dfa (make_dfa (make_nfa (postfix (r))));
+
+        BOOST_TEST (equivalent (dfa, expected), r);
+        BOOST_TEST (dfa.states.size () == expected.states.size (), r);
+    }
+
+    BOOST_TEST (compiler.compile ("a(b|c)*").states.size () == 2U);
+
+    const string a = "a";
+
+    compiler.compile ("a*$^", dfa);
+    BOOST_TEST (!match (dfa, a.data (), a.data () + a.size ()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
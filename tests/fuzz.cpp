@@ -0,0 +1,310 @@
+// -*- mode: c++; -*-
+
+//
+// Differential testing of the engines and constructions: random patterns within the supported
+// grammar and random input, checked against a reference matcher working on
+// the syntax tree of the pattern. By default a Boost test driven by a seeded
+// generator; built with -DRETA_LIBFUZZER it is a libFuzzer target where the
+// fuzzer input drives the same generator.
+//
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/derivative.hpp>
+
+#if !defined (RETA_LIBFUZZER)
+#  define BOOST_TEST_DYN_LINK
+#  define BOOST_TEST_MODULE fuzz
+
+#  include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+#endif // RETA_LIBFUZZER
+
+////////////////////////////////////////////////////////////////////////
+
+//
+// Source of the choices made by the generators, either a pseudo-random
+// generator or the bytes of a fuzzer input (zero once exhausted):
+//
+struct choices_t {
+    explicit choices_t (unsigned seed) : gen_ (seed), first_ (), last_ () { }
+
+    choices_t (const uint8_t* first, const uint8_t* last)
+        : first_ (first), last_ (last)
+        { }
+
+    size_t operator() (size_t n) {
+        if (first_)
+            return first_ == last_ ? 0 : *first_++ % n;
+
+        return uniform_int_distribution< size_t > (0, n - 1) (gen_);
+    }
+
+private:
+    mt19937 gen_;
+    const uint8_t* first_;
+    const uint8_t* last_;
+};
+
+struct node_t {
+    enum kind_t { literal, concatenation, alternation, closure } kind;
+    char c;
+    vector< unique_ptr< node_t > > nodes;
+};
+
+static const string alphabet = "abc";
+
+//
+// The literals of the patterns, the anchors among them, once for two of each
+// character of the input:
+//
+static const string pattern_alphabet = "abcabc^$";
+
+static unique_ptr< node_t >
+generate (choices_t& choices, size_t depth) {
+    auto p = make_unique< node_t > ();
+
+    const auto k = depth ? choices (4) : 0;
+    p->kind = node_t::kind_t (k);
+
+    switch (p->kind) {
+    case node_t::literal:
+        p->c = pattern_alphabet [choices (pattern_alphabet.size ())];
+        break;
+
+    case node_t::concatenation:
+    case node_t::alternation:
+        for (size_t i = 0, n = 2 + choices (2); i < n; ++i)
+            p->nodes.push_back (generate (choices, depth - 1));
+        break;
+
+    case node_t::closure:
+        p->nodes.push_back (generate (choices, depth - 1));
+        break;
+    }
+
+    return p;
+}
+
+//
+// Prints the tree with parentheses around every non-literal subexpression,
+// and sometimes around literals:
+//
+static string
+to_string (const node_t& node, choices_t& choices) {
+    switch (node.kind) {
+    case node_t::literal:
+        return choices (4) ? string (1, node.c) : string ("(") + node.c + ")";
+
+    case node_t::concatenation:
+    case node_t::alternation: {
+        string s;
+
+        for (const auto& p : node.nodes) {
+            if (!s.empty () && node.kind == node_t::alternation)
+                s += '|';
+
+            const auto t = to_string (*p, choices);
+            s += p->kind == node_t::literal ? t : "(" + t + ")";
+        }
+
+        return s;
+    }
+
+    case node_t::closure: {
+        const auto& p = *node.nodes.front ();
+
+        const auto t = to_string (p, choices);
+        return (p.kind == node_t::literal ? t : "(" + t + ")") + "*";
+    }
+    }
+
+    return { };
+}
+
+//
+// Reference matcher: the positions at which a match of the node, starting at
+// any of the given positions, can end:
+//
+static set< size_t >
+ends (const node_t& node, const string& s, const set< size_t >& from) {
+    set< size_t > to;
+
+    switch (node.kind) {
+    case node_t::literal:
+        //
+        // The anchors hold at either end of the input, consuming nothing:
+        //
+        for (const auto i : from)
+            if ('^' == node.c || '$' == node.c) {
+                if (i == ('^' == node.c ? 0 : s.size ()))
+                    to.insert (i);
+            }
+            else if (i < s.size () && s [i] == node.c)
+                to.insert (i + 1);
+        break;
+
+    case node_t::concatenation:
+        to = from;
+
+        for (const auto& p : node.nodes)
+            to = ends (*p, s, to);
+        break;
+
+    case node_t::alternation:
+        for (const auto& p : node.nodes) {
+            const auto t = ends (*p, s, from);
+            to.insert (t.begin (), t.end ());
+        }
+        break;
+
+    case node_t::closure:
+        to = from;
+
+        for (auto curr = from; !curr.empty (); ) {
+            set< size_t > next;
+
+            for (const auto i : ends (*node.nodes.front (), s, curr))
+                if (to.insert (i).second)
+                    next.insert (i);
+
+            curr = move (next);
+        }
+        break;
+    }
+
+    return to;
+}
+
+static string
+generate_input (choices_t& choices) {
+    string s (choices (10), 0);
+
+    for (auto& c : s)
+        c = alphabet [choices (alphabet.size ())];
+
+    return s;
+}
+
+template< typename T >
+static string
+serialize (const T& arg) {
+    stringstream ss;
+    ss << arg;
+    return ss.str ();
+}
+
+template< typename T >
+static bool
+round_trip (const T& arg) {
+    const auto s = serialize (arg);
+
+    T other;
+
+    stringstream ss (s);
+    ss >> other;
+
+    return other.start == arg.start && serialize (other) == s;
+}
+
+//
+// Runs one case, returns a description of the first disagreement found:
+//
+static string
+check (choices_t& choices) {
+    const auto tree = generate (choices, 1 + choices (4));
+    const auto r = to_string (*tree, choices);
+
+    const auto s = postfix (r);
+
+    const auto nfa = make_nfa (s);
+    const auto dfa = make_dfa (nfa);
+    const auto min = minimize_dfa_table (dfa);
+    const auto hopcroft = minimize_dfa_hopcroft (dfa);
+    const auto brzozowski = minimize_dfa_brzozowski (dfa);
+
+    const auto glushkov = make_glushkov_nfa (s);
+    const auto derivative = make_derivative_dfa (s);
+
+    if (min.states.size () > dfa.states.size ())
+        return r + " : minimization increased the number of states";
+
+    if (hopcroft.states.size () != min.states.size () ||
+        brzozowski.states.size () != min.states.size ())
+        return r + " : minimizers disagree on the number of states";
+
+    if (derivative.states.size () < min.states.size ())
+        return r + " : more derivatives than minimal states";
+
+    if (!round_trip (nfa) || !round_trip (glushkov) ||
+        !round_trip (dfa) || !round_trip (min))
+        return r + " : serialization does not round-trip";
+
+    for (size_t i = 0; i < 16; ++i) {
+        const auto s = generate_input (choices);
+        const auto first = s.data (), last = first + s.size ();
+
+        const auto expected = ends (*tree, s, { 0 }).count (s.size ()) > 0;
+
+        if (expected != match (nfa, first, last) ||
+            expected != match (glushkov, first, last) ||
+            expected != match (dfa, first, last) ||
+            expected != match (derivative, first, last) ||
+            expected != match (min, first, last) ||
+            expected != match (hopcroft, first, last) ||
+            expected != match (brzozowski, first, last))
+            return r + " : engines disagree on \"" + s + "\"";
+    }
+
+    return { };
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#if defined (RETA_LIBFUZZER)
+
+extern "C" int
+LLVMFuzzerTestOneInput (const uint8_t* data, size_t size) {
+    choices_t choices (data, data + size);
+
+    const auto failure = check (choices);
+
+    if (!failure.empty ()) {
+        cerr << failure << endl;
+        abort ();
+    }
+
+    return 0;
+}
+
+#else
+
+BOOST_AUTO_TEST_SUITE(fuzz)
+
+BOOST_AUTO_TEST_CASE (fuzz_engines) {
+    const auto n = getenv ("RETA_FUZZ_ITERATIONS");
+
+    choices_t choices (1);
+
+    for (size_t i = 0, m = n ? stoul (n) : 2000; i < m; ++i) {
+        const auto failure = check (choices);
+        BOOST_TEST (failure.empty (), failure);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // RETA_LIBFUZZER
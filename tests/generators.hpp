@@ -0,0 +1,73 @@
+// -*- mode: c++; -*-
+
+#ifndef RETA_TESTS_GENERATORS_HPP
+#define RETA_TESTS_GENERATORS_HPP
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//
+// Expressions whose minimal DFAs range from one state to a few dozen, over
+// the alphabet of the inputs below:
+//
+static const vector< string > table_patterns {
+    "a",
+    "a*",
+    "ab|c",
+    "(a|b)*",
+    "(a|b)*a(a|b)(a|b)",
+    "(a|b|c|d|e|f)*",
+    "(a|c|e|g)(b|d|f|h)*",
+    "((a|b|c|d)(e|f|g|h))*x"
+};
+
+//
+// All strings of length up to n over the alphabet:
+//
+static inline vector< string >
+make_input (const string& alphabet, size_t n) {
+    vector< string > v { "" };
+
+    for (size_t i = 0, first = 0; i < n; ++i) {
+        const auto last = v.size ();
+
+        for (; first < last; ++first)
+            for (const auto c : alphabet)
+                v.push_back (v [first] + c);
+    }
+
+    return v;
+}
+
+//
+// Random expressions of the depth over the literals, which may include the
+// anchors, and more than once to weigh them; every parenthesis is a group:
+//
+static inline string
+make_regex (mt19937& gen, size_t depth, const string& literals = "ab") {
+    const auto k = depth ? gen () % 5 : 0;
+
+    switch (k) {
+    case 0:
+        return string (1, literals [gen () % literals.size ()]);
+
+    case 1:
+        return make_regex (gen, depth - 1, literals) +
+            make_regex (gen, depth - 1, literals);
+
+    case 2:
+        return "(" + make_regex (gen, depth - 1, literals) + "|" +
+            make_regex (gen, depth - 1, literals) + ")";
+
+    case 3:
+        return "(" + make_regex (gen, depth - 1, literals) + ")*";
+
+    default:
+        return "(" + make_regex (gen, depth - 1, literals) + ")";
+    }
+}
+
+#endif // RETA_TESTS_GENERATORS_HPP
@@ -0,0 +1,67 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE jit
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/jit.hpp>
+#include <reta/table.hpp>
+
+#include "generators.hpp"
+
+#include <boost/format.hpp>
+using fmt = boost::format;
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(jit)
+
+BOOST_AUTO_TEST_CASE (jit_against_interpreter) {
+    const auto input = make_input ("abcdefx", 5);
+
+    for (const auto& r : table_patterns) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % r);
+
+        const auto dfa = minimize_dfa_table (make_dfa (make_nfa (postfix (r))));
+
+        const table_t table (dfa);
+
+        const jit_t jit (dfa);
+        const jit_t fallback (dfa, false);
+
+        BOOST_TEST (!fallback.native ());
+
+#if defined (__x86_64__) && defined (__linux__)
+        BOOST_TEST (jit.native ());
+#endif // __x86_64__ && __linux__
+
+        for (const auto& s : input) {
+            const auto first = s.data (), last = first + s.size ();
+            const auto expected = match (dfa, first, last);
+
+            BOOST_TEST (expected == match (table, first, last));
+            BOOST_TEST (expected == match (jit, first, last));
+            BOOST_TEST (expected == match (fallback, first, last));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (jit_non_alphabet_input) {
+    const auto dfa = make_dfa (make_nfa (postfix ("(a|b|c|d|e)*")));
+    const jit_t jit (dfa);
+
+    const string s ("abc\xff\x80z");
+
+    BOOST_TEST (!match (jit, s.data (), s.data () + s.size ()));
+    BOOST_TEST ( match (jit, s.data (), s.data () + 3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE layout
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/renumber.hpp>
+#include <reta/table.hpp>
+
+#include "generators.hpp"
+
+#include <boost/format.hpp>
+using fmt = boost::format;
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(layout)
+
+BOOST_AUTO_TEST_CASE (layout_renumbering) {
+    const auto input = make_input ("abcdefx", 4);
+
+    for (const auto& r : table_patterns) {
+        BOOST_TEST_MESSAGE (fmt ("testing : %1%") % r);
+
+        const auto dfa = minimize_dfa_table (make_dfa (make_nfa (postfix (r))));
+
+        const auto bfs = renumber (dfa, order_t::bfs);
+        const auto dfs = renumber (dfa, order_t::dfs);
+        const auto hot = renumber (dfa, profile (dfa, input));
+
+        BOOST_TEST (bfs.start == 0U);
+        BOOST_TEST (dfs.start == 0U);
+
+        //
+        // Room for two hot states only, the others escape to the full table:
+        //
+        const tiered_table_t tiered (hot, 2 * table_t::width * 2);
+
+        BOOST_TEST (tiered.hot_states == (min) (size_t (2), dfa.states.size ()));
+
+        for (const auto& s : input) {
+            const auto first = s.data (), last = first + s.size ();
+            const auto expected = match (dfa, first, last);
+
+            BOOST_TEST (expected == match (bfs, first, last));
+            BOOST_TEST (expected == match (dfs, first, last));
+            BOOST_TEST (expected == match (hot, first, last));
+            BOOST_TEST (expected == match (tiered, first, last));
+        }
+    }
+
+    //
+    // The most visited state comes first:
+    //
+    const auto dfa = make_dfa (make_nfa (postfix ("ab*")));
+    const auto counts = profile (dfa, { "abbbb" });
+
+    BOOST_TEST (renumber (dfa, counts).start != 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,72 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE parallel
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/parallel.hpp>
+#include <reta/table.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(parallel)
+
+BOOST_AUTO_TEST_CASE (parallel_scan) {
+    mt19937 gen (1);
+
+    for (size_t k : { 0, 3, 6 }) {
+        string r = "(a|b)*a";
+
+        for (size_t i = 0; i < k; ++i)
+            r += "(a|b)";
+
+        const table_t table (minimize_dfa (make_dfa (make_nfa (postfix (r)))));
+
+        //
+        // Every state mapped as if run alone:
+        //
+        for (const string s : { "", "a", "abba", "bbbbbbbbbbab", "abc" }) {
+            const auto first = s.data (), last = first + s.size ();
+            const auto mapping = scan_all (table, first, last);
+
+            for (size_t q = 0; q <= table.dead; ++q) {
+                auto t = q;
+
+                for (auto p = first; p != last; ++p)
+                    t = table.next [t * table_t::width + size_t (*p)];
+
+                BOOST_TEST (mapping [q] == t);
+            }
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            string s (1 << 20, 0);
+
+            for (auto& c : s)
+                c = "ab" [gen () % 2];
+
+            //
+            // Every other input dies in the middle:
+            //
+            if (i % 2)
+                s [gen () % s.size ()] = 'c';
+
+            const auto first = s.data (), last = first + s.size ();
+
+            for (size_t threads : { 2, 3, 8 })
+                BOOST_TEST (
+                    match (table, first, last) ==
+                    match_parallel (table, first, last, threads));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
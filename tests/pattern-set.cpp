@@ -0,0 +1,144 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE pattern_set
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/pattern-set.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static vector< string >
+make_words (size_t n, unsigned seed) {
+    mt19937 gen (seed);
+
+    uniform_int_distribution< int > len (0, 6), c ('a', 'c');
+
+    vector< string > v;
+
+    for (size_t i = 0; i < n; ++i) {
+        string s (len (gen), 0);
+
+        for (auto& x : s)
+            x = char (c (gen));
+
+        v.push_back (move (s));
+    }
+
+    return v;
+}
+
+//
+// The minimal DFA of a set of non-empty words, from scratch:
+//
+static dfa_t
+rebuild (const set< string >& words) {
+    if (words.empty ())
+        return dfa_t { { { } }, { }, 0 };
+
+    string r;
+
+    for (const auto& w : words)
+        r += (r.empty () ? "" : "|") + w;
+
+    return minimize_dfa (make_dfa (make_nfa (postfix (r))));
+}
+
+BOOST_AUTO_TEST_SUITE(pattern_set)
+
+BOOST_AUTO_TEST_CASE (pattern_set_basics) {
+    pattern_set_t p;
+
+    BOOST_TEST (p.insert ("tap"));
+    BOOST_TEST (p.insert ("taps"));
+    BOOST_TEST (p.insert ("top"));
+    BOOST_TEST (p.insert ("tops"));
+    BOOST_TEST (!p.insert ("top"));
+
+    BOOST_TEST (p.size () == 4U);
+
+    //
+    // t, a|o, p, s and the final state after s:
+    //
+    BOOST_TEST (p.states () == 5U);
+
+    BOOST_TEST (p.contains ("taps"));
+    BOOST_TEST (!p.contains ("ta"));
+
+    BOOST_TEST (p.erase ("taps"));
+    BOOST_TEST (!p.erase ("taps"));
+
+    BOOST_TEST (!p.contains ("taps"));
+    BOOST_TEST (p.contains ("tops"));
+    BOOST_TEST (p.contains ("tap"));
+
+    BOOST_TEST (p.states () == 6U);
+
+    BOOST_TEST (p.erase ("tap"));
+    BOOST_TEST (p.erase ("top"));
+    BOOST_TEST (p.erase ("tops"));
+
+    BOOST_TEST (p.states () == 1U);
+    BOOST_TEST (p.size () == 0U);
+}
+
+BOOST_AUTO_TEST_CASE (pattern_set_minimal) {
+    const auto words = make_words (200, 1);
+    const auto others = make_words (200, 2);
+
+    pattern_set_t p;
+    set< string > s;
+
+    mt19937 gen (3);
+
+    for (size_t i = 0; i < words.size (); ++i) {
+        //
+        // Touched states are bounded by the pattern, not by the set:
+        //
+        if (p.insert (words [i]))
+            BOOST_TEST (p.touched () <= 4 * (words [i].size () + 1));
+
+        s.insert (words [i]);
+
+        //
+        // Every other step removes a random word of the set:
+        //
+        if (i % 2 && !s.empty ()) {
+            auto iter = s.begin ();
+            advance (iter, gen () % s.size ());
+
+            BOOST_TEST (p.erase (*iter));
+            BOOST_TEST (p.touched () <= 4 * (iter->size () + 1));
+
+            s.erase (iter);
+        }
+
+        BOOST_TEST (p.size () == s.size ());
+
+        if (s.count (""))
+            continue;
+
+        const auto dfa = p.to_dfa ();
+
+        BOOST_TEST (dfa.states.size () == rebuild (s).states.size ());
+        BOOST_TEST (p.states () == dfa.states.size ());
+
+        for (const auto& w : others) {
+            const auto first = w.data (), last = first + w.size ();
+            BOOST_TEST (match (dfa, first, last) == (s.count (w) > 0));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
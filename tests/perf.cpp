@@ -1,16 +1,197 @@
 // -*- mode: c++; -*-
 
+#include <cstdint>
+#include <cstdlib>
+
+#include <atomic>
 #include <iostream>
+#include <new>
+#include <random>
 #include <string>
+#include <vector>
 
 using namespace std;
 
 #include <reta/nfa.hpp>
 #include <reta/dfa.hpp>
+#include <reta/aho-corasick.hpp>
+#include <reta/compiler.hpp>
+#include <reta/compressed-table.hpp>
+#include <reta/derivative.hpp>
 #include <reta/dot-graph.hpp>
+#include <reta/equivalence.hpp>
+#include <reta/jit.hpp>
+#include <reta/parallel.hpp>
+#include <reta/pattern-set.hpp>
+#include <reta/product.hpp>
+#include <reta/regex.hpp>
+#include <reta/renumber.hpp>
+#include <reta/table.hpp>
+#include <reta/tdfa.hpp>
 
 #include <benchmark/benchmark.h>
 
+#if defined (__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif // __linux__
+
+////////////////////////////////////////////////////////////////////////
+//
+// Counting allocator: every allocation carries a header with its size so
+// that the live and the peak byte counts can be kept.
+//
+
+namespace {
+
+struct alloc_stats_t {
+    atomic< size_t > count, bytes, live, peak;
+};
+
+alloc_stats_t alloc_stats { };
+
+constexpr size_t alloc_header = alignof (max_align_t);
+
+} // namespace
+
+void* operator new (size_t n) {
+    auto p = static_cast< char* > (malloc (n + alloc_header));
+
+    if (0 == p)
+        throw bad_alloc ();
+
+    *reinterpret_cast< size_t* > (p) = n;
+
+    alloc_stats.count += 1;
+    alloc_stats.bytes += n;
+
+    const size_t live = alloc_stats.live += n;
+    auto peak = alloc_stats.peak.load ();
+
+    while (peak < live && !alloc_stats.peak.compare_exchange_weak (peak, live))
+        ;
+
+    return p + alloc_header;
+}
+
+//
+// GCC cannot tell that the block came from malloc in operator new:
+//
+#if defined (__GNUC__) && !defined (__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif // __GNUC__
+
+void operator delete (void* p) noexcept {
+    if (p) {
+        auto q = static_cast< char* > (p) - alloc_header;
+
+        alloc_stats.live -= *reinterpret_cast< size_t* > (q);
+        free (q);
+    }
+}
+
+#if defined (__GNUC__) && !defined (__clang__)
+#  pragma GCC diagnostic pop
+#endif // __GNUC__
+
+void operator delete (void* p, size_t) noexcept {
+    operator delete (p);
+}
+
+//
+// Allocations made between construction and report, per iteration, and the
+// peak of live bytes above the starting level:
+//
+struct alloc_counter_t {
+    alloc_counter_t ()
+        : count (alloc_stats.count), bytes (alloc_stats.bytes),
+          live (alloc_stats.live) {
+        alloc_stats.peak = live;
+    }
+
+    void report (benchmark::State& state) const {
+        const auto n = double (
+            (max) (state.iterations (), benchmark::IterationCount (1)));
+
+        state.counters ["allocs"] = (alloc_stats.count - count) / n;
+        state.counters ["bytes"] = (alloc_stats.bytes - bytes) / n;
+        state.counters ["peak"] = alloc_stats.peak - live;
+    }
+
+    size_t count, bytes, live;
+};
+
+////////////////////////////////////////////////////////////////////////
+//
+// Hardware cache-miss counters of the calling thread, user space only: L1 data
+// and last-level read misses. Where perf events are not available (other
+// systems, no PMU in a virtual machine, or a restrictive perf_event_paranoid)
+// nothing is reported.
+//
+
+struct cache_counters_t {
+    cache_counters_t () : fds { -1, -1 } {
+#if defined (__linux__)
+        static const uint64_t configs [] = {
+            PERF_COUNT_HW_CACHE_L1D,
+            PERF_COUNT_HW_CACHE_LL
+        };
+
+        for (size_t i = 0; i < 2; ++i) {
+            perf_event_attr attr { };
+
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.size = sizeof attr;
+            attr.config = configs [i] |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            fds [i] = int (syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0));
+
+            if (0 <= fds [i])
+                ioctl (fds [i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif // __linux__
+    }
+
+    ~cache_counters_t () {
+#if defined (__linux__)
+        for (const auto fd : fds)
+            if (0 <= fd)
+                close (fd);
+#endif // __linux__
+    }
+
+    void report (benchmark::State& state) const {
+#if defined (__linux__)
+        static const char* names [] = { "l1d_misses", "llc_misses" };
+
+        for (size_t i = 0; i < 2; ++i) {
+            uint64_t value = 0;
+
+            if (0 > fds [i] ||
+                ssize_t (sizeof value) != read (fds [i], &value, sizeof value))
+                continue;
+
+            state.counters [names [i]] = benchmark::Counter (
+                double (value), benchmark::Counter::kAvgIterations);
+        }
+#else
+        (void)state;
+#endif // __linux__
+    }
+
+    int fds [2];
+};
+
+////////////////////////////////////////////////////////////////////////
+
 static const vector< string > test_data {
     "a",
     "a*",
@@ -19,7 +200,7 @@ static const vector< string > test_data {
     "a|b",
     "(a*|b)",
     "(a|b*)",
-    "(a|b)*"
+    "(a|b)*",
     "(((a|b)*)a)",
     "((((a|b)*)a)(a|b))",
     "(((((a|b)*)a)(a|b))(a|b))",
@@ -34,12 +215,496 @@ static const vector< string > test_data {
     "((((((((((((((a|b)*)a)(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))(a|b))"
 };
 
+//
+// (a|b)*a(a|b){k}, whose DFA has 2^(k+1) states:
+//
+static string
+explosive (size_t k) {
+    string s = "(a|b)*a";
+
+    for (size_t i = 0; i < k; ++i)
+        s += "(a|b)";
+
+    return s;
+}
+
+//
+// Random words of 3 to 10 letters, and their union:
+//
+static vector< string >
+make_words (size_t n) {
+    mt19937 gen (4);
+
+    uniform_int_distribution< int > len (3, 10), c ('a', 'z');
+
+    vector< string > v;
+
+    for (size_t i = 0; i < n; ++i) {
+        string s (len (gen), 0);
+
+        for (auto& x : s)
+            x = char (c (gen));
+
+        v.push_back (move (s));
+    }
+
+    return v;
+}
+
+static string
+make_literals (size_t n) {
+    string s;
+
+    for (const auto& w : make_words (n))
+        s += (s.empty () ? "" : "|") + w;
+
+    return s;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// Matching corpora, lines of text with a pattern that the lines are matched
+// against: random letters, log-like sequences of a small vocabulary and lines
+// that run the DFA of an exploding pattern to the very end.
+//
+
+struct corpus_t {
+    string pattern;
+    vector< string > lines;
+};
+
+static corpus_t
+make_random_corpus (size_t n) {
+    mt19937 gen (1);
+
+    uniform_int_distribution< int > len (16, 128), c ('a', 'z');
+
+    corpus_t corpus {
+        "(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)*z", { }
+    };
+
+    for (size_t bytes = 0; bytes < n; ) {
+        string s (len (gen), 0);
+
+        for (auto& x : s)
+            x = char (c (gen));
+
+        bytes += s.size ();
+        corpus.lines.push_back (move (s));
+    }
+
+    return corpus;
+}
+
+static corpus_t
+make_log_corpus (size_t n) {
+    static const vector< string > levels { "info", "warn", "error" };
+    static const vector< string > words {
+        "get", "post", "user", "session", "login", "logout", "id", "ok"
+    };
+
+    mt19937 gen (2);
+
+    uniform_int_distribution< size_t > len (2, 12);
+    uniform_int_distribution< size_t > level (0, levels.size () - 1);
+    uniform_int_distribution< size_t > word (0, words.size () - 1);
+
+    corpus_t corpus {
+        "(info|warn|error)(get|post)(user|session|login|logout|id|ok)*", { }
+    };
+
+    for (size_t bytes = 0; bytes < n; ) {
+        auto s = levels [level (gen)];
+
+        for (size_t i = 0, m = len (gen); i < m; ++i)
+            s += words [word (gen)];
+
+        bytes += s.size ();
+        corpus.lines.push_back (move (s));
+    }
+
+    return corpus;
+}
+
+static corpus_t
+make_adversarial_corpus (size_t n) {
+    mt19937 gen (3);
+
+    uniform_int_distribution< int > len (64, 256), c ('a', 'b');
+
+    corpus_t corpus { explosive (8), { } };
+
+    for (size_t bytes = 0; bytes < n; ) {
+        string s (len (gen), 0);
+
+        for (auto& x : s)
+            x = char (c (gen));
+
+        bytes += s.size ();
+        corpus.lines.push_back (move (s));
+    }
+
+    return corpus;
+}
+
+static const vector< corpus_t >&
+corpora () {
+    static const vector< corpus_t > v {
+        make_random_corpus (1 << 20),
+        make_log_corpus (1 << 20),
+        make_adversarial_corpus (1 << 20)
+    };
+
+    return v;
+}
+
+template< typename T >
+struct engine_t {
+    engine_t (const nfa_t&, const dfa_t& dfa) : value (dfa) { }
+    T value;
+};
+
+template< >
+struct engine_t< nfa_t > {
+    engine_t (const nfa_t& nfa, const dfa_t&) : value (nfa) { }
+    nfa_t value;
+};
+
+//
+// The automata narrowed to bytes and 16-bit state ids, 4 bytes a transition
+// in place of 16:
+//
+template< typename T >
+struct engine_t< compact_dfa_t< T > > {
+    engine_t (const nfa_t&, const dfa_t& dfa)
+        : value (automaton_cast< compact_dfa_t< T > > (dfa)) { }
+
+    compact_dfa_t< T > value;
+};
+
+template< typename T >
+struct engine_t< compact_nfa_t< T > > {
+    engine_t (const nfa_t& nfa, const dfa_t&)
+        : value (automaton_cast< compact_nfa_t< T > > (nfa)) { }
+
+    compact_nfa_t< T > value;
+};
+
+template< typename T >
+static void
+BM_match (benchmark::State& state) {
+    const auto& corpus = corpora () [state.range (0)];
+
+    const auto nfa = make_nfa (postfix (corpus.pattern));
+    const auto dfa = minimize_dfa_table (make_dfa (nfa));
+
+    const engine_t< T > engine (nfa, dfa);
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : corpus.lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : corpus.lines)
+            matches += match (engine.value, s.data (), s.data () + s.size ());
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+    state.counters ["matches"] = double (matches) / state.iterations ();
+}
+
+BENCHMARK_TEMPLATE (BM_match, dfa_t)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match, compact_dfa_t< uint16_t >)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match, table_t)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match, jit_t)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match, nfa_t)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match, compact_nfa_t< uint16_t >)->DenseRange (0, 2);
+
+BENCHMARK_TEMPLATE (BM_match, table_t)
+    ->DenseRange (0, 2)->ThreadRange (2, 8)->UseRealTime ();
+
+BENCHMARK_TEMPLATE (BM_match, jit_t)
+    ->DenseRange (0, 2)->ThreadRange (2, 8)->UseRealTime ();
+
+//
+// "Matches A but not B" over the log corpus, as two scans or as one over the
+// product automaton:
+//
+static void
+BM_match_difference (benchmark::State& state) {
+    const auto& corpus = corpora () [1];
+
+    const auto a = minimize_dfa (make_dfa (make_nfa (postfix (corpus.pattern))));
+    const auto b = minimize_dfa (make_dfa (make_nfa (postfix (
+        "(info|warn|error)(get|post)(user|session|login|logout|id|ok)*ok"))));
+
+    const auto d = difference (a, b, true);
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : corpus.lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : corpus.lines) {
+            const auto first = s.data (), last = first + s.size ();
+
+            matches += state.range (0)
+                ? match (d, first, last)
+                : match (a, first, last) && !match (b, first, last);
+        }
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+    state.counters ["matches"] = double (matches) / state.iterations ();
+}
+
+BENCHMARK (BM_match_difference)->DenseRange (0, 1);
+
+//
+// Table layouts: the states as the minimizer numbers them, in breadth-first,
+// depth-first and profile order, and the profile order with the hot rows in a
+// narrow table of their own. The profile is taken over the first lines of the
+// corpus:
+//
+enum layout_t { minimized, bfs, dfs, hot, tiered };
+
+template< layout_t L >
+static void
+BM_match_layout (benchmark::State& state) {
+    const auto& corpus = corpora () [state.range (0)];
+
+    const auto nfa = make_nfa (postfix (corpus.pattern));
+    const auto dfa = minimize_dfa (make_dfa (nfa));
+
+    const vector< string > sample (
+        corpus.lines.begin (),
+        corpus.lines.begin () + (min) (corpus.lines.size (), size_t (256)));
+
+    dfa_t layout;
+
+    switch (L) {
+    case minimized: layout = dfa; break;
+    case bfs:       layout = renumber (dfa, order_t::bfs); break;
+    case dfs:       layout = renumber (dfa, order_t::dfs); break;
+    case hot:
+    case tiered:    layout = renumber (dfa, profile (dfa, sample)); break;
+    }
+
+    const table_t table (layout);
+    const tiered_table_t tiered_table (layout);
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : corpus.lines)
+        bytes += s.size ();
+
+    cache_counters_t counters;
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : corpus.lines) {
+            const auto first = s.data (), last = first + s.size ();
+
+            matches += L == tiered
+                ? match (tiered_table, first, last)
+                : match (table, first, last);
+        }
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    counters.report (state);
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+    state.counters ["states"] = dfa.states.size ();
+}
+
+BENCHMARK_TEMPLATE (BM_match_layout, minimized)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match_layout, bfs)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match_layout, dfs)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match_layout, hot)->DenseRange (0, 2);
+BENCHMARK_TEMPLATE (BM_match_layout, tiered)->DenseRange (0, 2);
+
+//
+// Compressed table formats: bytes per state against throughput, on the
+// corpora and on a large union of literals, a trie matched against its own
+// words:
+//
+static size_t
+table_bytes (const table_t& table) {
+    return
+        table.next.size () * sizeof (table.next [0]) + table.accept.size () / 8;
+}
+
+template< typename T >
+static size_t
+table_bytes (const T& table) {
+    return table.bytes ();
+}
+
+template< typename Table >
+static void
+BM_match_compressed (benchmark::State& state) {
+    vector< string > lines;
+    dfa_t dfa;
+
+    if (state.range (0) < 3) {
+        const auto& corpus = corpora () [state.range (0)];
+
+        lines = corpus.lines;
+        dfa = minimize_dfa (make_dfa (make_nfa (postfix (corpus.pattern))));
+    }
+    else {
+        lines = make_words (4096);
+
+        pattern_set_t p;
+
+        for (const auto& w : lines)
+            p.insert (w);
+
+        dfa = p.to_dfa ();
+    }
+
+    const Table table (dfa);
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : lines)
+            matches += match (table, s.data (), s.data () + s.size ());
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+
+    state.counters ["states"] = dfa.states.size ();
+    state.counters ["bytes_per_state"] =
+        double (table_bytes (table)) / (dfa.states.size () + 1);
+}
+
+BENCHMARK_TEMPLATE (BM_match_compressed, table_t)->DenseRange (0, 3);
+BENCHMARK_TEMPLATE (BM_match_compressed, dense_table_t< uint16_t >)
+    ->DenseRange (0, 3);
+BENCHMARK_TEMPLATE (BM_match_compressed, dense_table_t< uint32_t >)
+    ->DenseRange (0, 3);
+BENCHMARK_TEMPLATE (BM_match_compressed, comb_table_t< uint16_t >)
+    ->DenseRange (0, 3);
+BENCHMARK_TEMPLATE (BM_match_compressed, comb_table_t< uint32_t >)
+    ->DenseRange (0, 3);
+
+//
+// One 16 MiB input over the exploding patterns, split across threads:
+//
+static void
+BM_match_parallel (benchmark::State& state) {
+    const table_t table (minimize_dfa (make_dfa (make_nfa (postfix (
+        explosive (state.range (0)))))));
+
+    mt19937 gen (5);
+
+    string s (16 << 20, 0);
+
+    for (auto& c : s)
+        c = "ab" [gen () % 2];
+
+    size_t matches = 0;
+
+    while (state.KeepRunning ()) {
+        matches += match_parallel (
+            table, s.data (), s.data () + s.size (), state.range (1));
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * s.size ());
+    state.counters ["states"] = table.dead;
+}
+
+BENCHMARK (BM_match_parallel)
+    ->ArgsProduct ({ { 2, 6, 10 }, { 1, 2, 4, 8 } })->UseRealTime ();
+
+//
+// One compiled expression shared by all threads, each matching its own copy
+// of a slice of the log corpus with scratch leased once from a shared pool:
+// the table, range 0, the NFA simulation, range 1, and the TDFA with its
+// registers, range 2. With no shared writes, the throughput scales with the
+// threads up to the cores of the machine: the bytes per second are those of
+// all threads, and per_thread, their average, stays flat.
+//
+static void
+BM_match_shared (benchmark::State& state) {
+    static const auto handles = [] {
+        const auto& r = corpora () [1].pattern;
+
+        regex_options_t nfa, captures;
+
+        nfa.dfa.max_states = 0;
+        captures.captures = true;
+
+        return vector< regex_handle_t > {
+            compile_regex (r), compile_regex (r, nfa),
+            compile_regex (r, captures)
+        };
+    } ();
+
+    static scratch_pool_t pool;
+
+    const auto regex = handles [state.range (0)];
+
+    const auto& corpus = corpora () [1].lines;
+    const vector< string > lines (corpus.begin (), corpus.begin () + 1024);
+
+    auto scratch = pool.acquire ();
+
+    captures_t captures;
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : lines) {
+            const auto first = s.data (), last = first + s.size ();
+
+            matches += 2 == state.range (0)
+                ? match (*regex, first, last, captures, *scratch)
+                : match (*regex, first, last, *scratch);
+        }
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+
+    state.counters ["per_thread"] = benchmark::Counter (
+        double (state.iterations () * bytes),
+        benchmark::Counter::kIsRate | benchmark::Counter::kAvgThreads);
+}
+
+BENCHMARK (BM_match_shared)
+    ->DenseRange (0, 2)->ThreadRange (1, 64)->UseRealTime ();
+
+////////////////////////////////////////////////////////////////////////
+
 static void
 BM_nfa (benchmark::State& state) {
     const auto s = postfix (test_data [state.range (0)]);
 
+    alloc_counter_t counter;
+
     while (state.KeepRunning ())
         benchmark::DoNotOptimize (make_nfa (s));
+
+    counter.report (state);
 }
 
 BENCHMARK (BM_nfa)->DenseRange (0, test_data.size () - 1);
@@ -49,8 +714,12 @@ BM_dfa (benchmark::State& state) {
     const auto s = postfix (test_data [state.range (0)]);
     const auto nfa = make_nfa (s);
 
+    alloc_counter_t counter;
+
     while (state.KeepRunning ())
         benchmark::DoNotOptimize (make_dfa (nfa));
+
+    counter.report (state);
 }
 
 BENCHMARK (BM_dfa)->DenseRange (0, test_data.size () - 1);
@@ -62,10 +731,639 @@ BM_min_dfa (benchmark::State& state) {
     const auto nfa = make_nfa (s);
     const auto dfa = make_dfa (nfa);
 
+    alloc_counter_t counter;
+
     while (state.KeepRunning ())
         benchmark::DoNotOptimize (minimize_dfa_table (dfa));
+
+    counter.report (state);
 }
 
 BENCHMARK (BM_min_dfa)->DenseRange (0, test_data.size () - 1);
 
+//
+// Glushkov construction, and the subset construction over its epsilon-free
+// automaton:
+//
+static void
+BM_glushkov_nfa (benchmark::State& state) {
+    const auto s = postfix (test_data [state.range (0)]);
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (make_glushkov_nfa (s));
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_glushkov_nfa)->DenseRange (0, test_data.size () - 1);
+
+static void
+BM_glushkov_dfa (benchmark::State& state) {
+    const auto s = postfix (test_data [state.range (0)]);
+    const auto nfa = make_glushkov_nfa (s);
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (make_dfa (nfa));
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_glushkov_dfa)->DenseRange (0, test_data.size () - 1);
+
+//
+// The construction of the DFA after the rewrites of simplify (), range 1,
+// against that of the expression as written, over the corpus and patterns
+// that the rewrites target; the counters hold the sizes of both automata.
+//
+static const vector< string >&
+simplify_data () {
+    static vector< string > v;
+
+    if (v.empty ()) {
+        v = test_data;
+
+        v.push_back ("(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)*z");
+        v.push_back ("(((a*)*)*|b*)*");
+        v.push_back ("abc|abd|abe|xbc|xbd");
+        v.push_back (make_literals (64));
+        v.push_back (make_literals (512));
+    }
+
+    return v;
+}
+
+static void
+BM_simplify (benchmark::State& state) {
+    const auto s = postfix (simplify_data () [state.range (0)]);
+    const auto t = simplify (s);
+
+    const auto& r = state.range (1) ? t : s;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (make_dfa (make_nfa (r)));
+
+    const auto a = make_nfa (s), b = make_nfa (t);
+
+    state.counters ["nfa"] = a.states.size ();
+    state.counters ["dfa"] = make_dfa (a).states.size ();
+
+    state.counters ["simplified_nfa"] = b.states.size ();
+    state.counters ["simplified_dfa"] = make_dfa (b).states.size ();
+}
+
+BENCHMARK (BM_simplify)->ArgsProduct ({
+        benchmark::CreateDenseRange (0, int (test_data.size ()) + 4, 1),
+        { 0, 1 } });
+
+//
+// Compilation of ten thousand small patterns, words with alternations and
+// closures of other words, to minimal DFAs: afresh through the pipeline, range
+// 0, and through one compiler into one output, range 1, whose buffers stop
+// growing after the first patterns. The counters are per pattern.
+//
+static void
+BM_compile (benchmark::State& state) {
+    static constexpr size_t n = 10000;
+
+    vector< string > patterns;
+
+    {
+        const auto words = make_words (n + 2);
+
+        for (size_t i = 0; i < n; ++i)
+            patterns.push_back (
+                words [i] + "(" + words [i + 1] + "|" + words [i + 2] + ")*" +
+                string (1, words [i][0]));
+    }
+
+    compiler_t compiler;
+    dfa_t dfa;
+
+    size_t states = 0;
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ()) {
+        for (const auto& r : patterns) {
+            if (state.range (0))
+                compiler.compile (r, dfa);
+            else
+                dfa = minimize_dfa (make_dfa (make_nfa (postfix (r))));
+
+            states += dfa.states.size ();
+        }
+
+        benchmark::DoNotOptimize (states);
+    }
+
+    counter.report (state);
+
+    state.counters ["allocs"] = state.counters ["allocs"] / n;
+    state.counters ["bytes"] = state.counters ["bytes"] / n;
+
+    state.counters ["states"] = double (states) / state.iterations () / n;
+    state.SetItemsProcessed (state.iterations () * n);
+}
+
+BENCHMARK (BM_compile)->DenseRange (0, 1)->Unit (benchmark::kMillisecond);
+
+//
+// Direct construction from derivatives, against the whole pipeline of NFA,
+// subset construction and minimization that it replaces:
+//
+static void
+BM_derivative_dfa (benchmark::State& state) {
+    const auto s = postfix (test_data [state.range (0)]);
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (make_derivative_dfa (s));
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_derivative_dfa)->DenseRange (0, test_data.size () - 1);
+
+static void
+BM_pipeline_dfa (benchmark::State& state) {
+    const auto s = postfix (test_data [state.range (0)]);
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (minimize_dfa_table (make_dfa (make_nfa (s))));
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_pipeline_dfa)->DenseRange (0, test_data.size () - 1);
+
+////////////////////////////////////////////////////////////////////////
+//
+// Construction scaling: the NFA is linear in the length of the pattern, the
+// subset construction linear in the number of DFA states it produces and the
+// table minimization quadratic in it.
+//
+
+static void
+BM_nfa_scaling (benchmark::State& state) {
+    const auto s = postfix (explosive (state.range (0)));
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (make_nfa (s));
+
+    counter.report (state);
+    state.SetComplexityN (s.size ());
+}
+
+BENCHMARK (BM_nfa_scaling)
+    ->RangeMultiplier (2)->Range (8, 1 << 10)->Complexity (benchmark::oN);
+
+static void
+BM_dfa_scaling (benchmark::State& state) {
+    const auto nfa = make_nfa (postfix (explosive (state.range (0))));
+
+    alloc_counter_t counter;
+    size_t n = 0;
+
+    while (state.KeepRunning ()) {
+        const auto dfa = make_dfa (nfa);
+        n = dfa.states.size ();
+    }
+
+    counter.report (state);
+    state.SetComplexityN (n);
+}
+
+BENCHMARK (BM_dfa_scaling)->DenseRange (1, 12)->Complexity (benchmark::oNLogN);
+
+static void
+BM_min_dfa_scaling (benchmark::State& state) {
+    const auto dfa = make_dfa (make_nfa (postfix (explosive (state.range (0)))));
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (minimize_dfa_table (dfa));
+
+    counter.report (state);
+    state.SetComplexityN (dfa.states.size ());
+}
+
+BENCHMARK (BM_min_dfa_scaling)
+    ->DenseRange (1, 8)->Complexity (benchmark::oNSquared);
+
+////////////////////////////////////////////////////////////////////////
+//
+// The minimizers against each other, on the exploding patterns, whose DFA is
+// already minimal, and on unions of literals, whose DFA is a trie with many
+// equivalent states:
+//
+
+enum minimizer_t { table, hopcroft, brzozowski, selected };
+
+template< minimizer_t M >
+static void
+BM_minimize (benchmark::State& state) {
+    const auto k = size_t (state.range (1));
+
+    const auto dfa = make_dfa (make_nfa (postfix (
+        state.range (0) ? make_literals (k) : explosive (k))));
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ()) {
+        switch (M) {
+        case table:
+            benchmark::DoNotOptimize (minimize_dfa_table (dfa));
+            break;
+
+        case hopcroft:
+            benchmark::DoNotOptimize (minimize_dfa_hopcroft (dfa));
+            break;
+
+        case brzozowski:
+            benchmark::DoNotOptimize (minimize_dfa_brzozowski (dfa));
+            break;
+
+        case selected:
+            benchmark::DoNotOptimize (minimize_dfa (dfa));
+            break;
+        }
+    }
+
+    counter.report (state);
+    state.counters ["states"] = dfa.states.size ();
+}
+
+static void
+minimizer_arguments (benchmark::internal::Benchmark* b) {
+    for (int k : { 1, 4, 7, 10 })
+        b->Args ({ 0, k });
+
+    for (int k : { 4, 16, 64, 256 })
+        b->Args ({ 1, k });
+}
+
+BENCHMARK_TEMPLATE (BM_minimize, table)->Apply (minimizer_arguments);
+BENCHMARK_TEMPLATE (BM_minimize, hopcroft)->Apply (minimizer_arguments);
+BENCHMARK_TEMPLATE (BM_minimize, brzozowski)->Apply (minimizer_arguments);
+BENCHMARK_TEMPLATE (BM_minimize, selected)->Apply (minimizer_arguments);
+
+////////////////////////////////////////////////////////////////////////
+//
+// Equivalence of the Thompson and the Glushkov DFAs of the exploding patterns,
+// by bisimulation against minimizing and comparing both:
+//
+
+static void
+BM_equivalent (benchmark::State& state) {
+    const auto s = postfix (explosive (state.range (1)));
+
+    const auto a = make_dfa (make_nfa (s));
+    const auto b = make_dfa (make_glushkov_nfa (s));
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ()) {
+        if (state.range (0))
+            benchmark::DoNotOptimize (equivalent (a, b));
+        else {
+            const auto x = minimize_dfa (a), y = minimize_dfa (b);
+            benchmark::DoNotOptimize (x.states.size () == y.states.size ());
+        }
+    }
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_equivalent)
+    ->ArgsProduct ({ { 0, 1 }, { 2, 6, 10 } });
+
+////////////////////////////////////////////////////////////////////////
+//
+// Adding and removing one literal to a set of n, incrementally, against
+// rebuilding and minimizing the automaton of the union:
+//
+
+static void
+BM_pattern_set_update (benchmark::State& state) {
+    const auto words = make_words (state.range (0) + 1);
+
+    pattern_set_t p;
+
+    for (size_t i = 1; i < words.size (); ++i)
+        p.insert (words [i]);
+
+    alloc_counter_t counter;
+    size_t touched = 0;
+
+    while (state.KeepRunning ()) {
+        p.insert (words [0]);
+        touched += p.touched ();
+
+        p.erase (words [0]);
+        touched += p.touched ();
+    }
+
+    counter.report (state);
+
+    state.counters ["states"] = p.states ();
+    state.counters ["touched"] = benchmark::Counter (
+        double (touched), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK (BM_pattern_set_update)->RangeMultiplier (4)->Range (16, 4096);
+
+static void
+BM_pattern_set_rebuild (benchmark::State& state) {
+    const auto s = postfix (make_literals (state.range (0) + 1));
+
+    alloc_counter_t counter;
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (minimize_dfa (make_dfa (make_nfa (s))));
+
+    counter.report (state);
+}
+
+BENCHMARK (BM_pattern_set_rebuild)->RangeMultiplier (4)->Range (16, 1024);
+
+////////////////////////////////////////////////////////////////////////
+//
+// Literal sets: the generic pipeline against the Aho-Corasick automaton built
+// from the literals, and the search with and without the Teddy prefilter.
+//
+
+static void
+BM_literals_generic (benchmark::State& state) {
+    const auto s = postfix (make_literals (state.range (0)));
+
+    while (state.KeepRunning ())
+        benchmark::DoNotOptimize (minimize_dfa (make_dfa (make_nfa (s))));
+}
+
+BENCHMARK (BM_literals_generic)->RangeMultiplier (4)->Range (16, 4096);
+
+static void
+BM_literals_aho_corasick (benchmark::State& state) {
+    const auto s = postfix (make_literals (state.range (0)));
+
+    vector< string > v;
+
+    while (state.KeepRunning ()) {
+        literals_of (s, v);
+        benchmark::DoNotOptimize (aho_corasick_t (v));
+    }
+}
+
+BENCHMARK (BM_literals_aho_corasick)->RangeMultiplier (4)->Range (16, 4096);
+
+static void
+BM_search_literals (benchmark::State& state) {
+    //
+    // Words repeated twice, 6 to 20 letters, most of which never occur in the
+    // random text, so that the search runs to the end of the input:
+    //
+    auto words = make_words (state.range (0));
+
+    for (auto& w : words)
+        w += w;
+
+    const aho_corasick_t ac (words, state.range (1));
+
+    mt19937 gen (6);
+
+    string s (16 << 20, 0);
+
+    for (auto& c : s)
+        c = char ('a' + gen () % 26);
+
+    size_t matches = 0;
+
+    while (state.KeepRunning ()) {
+        //
+        // Searches the 64 KiB blocks of the input one at a time:
+        //
+        for (size_t i = 0; i < s.size (); i += 64 << 10)
+            matches += search (ac, &s [i], &s [i] + (64 << 10));
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * s.size ());
+
+    state.counters ["prefilter"] = ac.prefilter ();
+    state.counters ["bytes"] = ac.bytes ();
+}
+
+BENCHMARK (BM_search_literals)
+    ->ArgsProduct ({ { 1, 8, 16, 64, 512 }, { 0, 1 } });
+
+////////////////////////////////////////////////////////////////////////
+//
+// Submatch extraction: the tagged DFA against the plain table, which only
+// decides the match, on the same lines; range 1 is the number of groups around
+// the parts of the explosive pattern.
+//
+
+static string
+tagged_pattern (size_t groups) {
+    static const char* parts [] = { "(a|b)*", "a", "(a|b)", "(a|b)" };
+
+    string s;
+
+    for (size_t i = 0; i < 4; ++i)
+        s += i < groups ? string ("(") + parts [i] + ")" : parts [i];
+
+    return s;
+}
+
+static void
+BM_match_captures (benchmark::State& state) {
+    const auto r = tagged_pattern (state.range (1));
+
+    size_t groups = 0;
+    const auto nfa = make_nfa (postfix_captures (r, &groups));
+
+    const auto tdfa = make_tdfa (nfa, 2 * groups);
+    const table_t table (minimize_dfa (make_dfa (make_nfa (postfix (r)))));
+
+    mt19937 gen (7);
+
+    vector< string > lines (4096);
+
+    for (auto& s : lines) {
+        s.resize (gen () % 128);
+
+        for (auto& c : s)
+            c = "ab" [gen () % 2];
+    }
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : lines)
+        bytes += s.size ();
+
+    captures_t captures;
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : lines) {
+            const auto first = s.data (), last = first + s.size ();
+
+            matches += state.range (0)
+                ? match (tdfa, first, last, captures)
+                : match (table, first, last);
+        }
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+
+    state.counters ["states"] = tdfa.dead;
+    state.counters ["registers"] = tdfa.registers;
+}
+
+BENCHMARK (BM_match_captures)->ArgsProduct ({ { 0, 1 }, { 0, 1, 2, 4 } });
+
+////////////////////////////////////////////////////////////////////////
+//
+// Unanchored search in lines of random text: the search DFA in one pass
+// against the anchored earliest DFA restarted at every offset of the line;
+// range 1 picks a pattern rarely found, or one found in most lines.
+//
+
+static void
+BM_search (benchmark::State& state) {
+    static const char* patterns [] = { "(ab|cd)(e|f)*gh", "a(b|c)" };
+
+    const auto nfa = make_nfa (postfix (patterns [state.range (1)]));
+
+    dfa_options_t options;
+    options.earliest = true;
+
+    dfa_t dfa;
+    make_dfa (nfa, options, dfa);
+
+    const search_table_t prefix (minimize_dfa (dfa));
+
+    options.unanchored = true;
+    make_dfa (nfa, options, dfa);
+
+    const search_table_t table (minimize_dfa (dfa));
+
+    mt19937 gen (8);
+
+    vector< string > lines (4096);
+
+    for (auto& s : lines) {
+        s.resize (gen () % 256);
+
+        for (auto& c : s)
+            c = char ('a' + gen () % 26);
+    }
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : lines) {
+            const auto first = s.data (), last = first + s.size ();
+
+            if (state.range (0))
+                matches += search (table, first, last);
+            else {
+                auto p = first;
+                for (; p != last && !search (prefix, p, last); ++p) ;
+
+                matches += p != last;
+            }
+        }
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+    state.counters ["states"] = table.table.dead;
+}
+
+BENCHMARK (BM_search)->ArgsProduct ({ { 0, 1 }, { 0, 1 } });
+
+////////////////////////////////////////////////////////////////////////
+//
+// Unicode classes: the construction of the byte-level DFA of a class of code
+// points, range 0 picking the class, and the dense table of its closure over
+// text in several scripts, byte at a time.
+//
+
+static const char* unicode_classes [] = {
+    "[a-z]", "\\p{Nd}", "\\p{L}", "[\\p{L}\\p{Z}\\p{P}]"
+};
+
+static void
+BM_utf8_dfa (benchmark::State& state) {
+    const auto s = postfix (unicode_classes [state.range (0)]);
+
+    size_t states = 0;
+
+    while (state.KeepRunning ()) {
+        const auto dfa = minimize_dfa (make_dfa (make_nfa (s)));
+        benchmark::DoNotOptimize (states = dfa.states.size ());
+    }
+
+    state.counters ["nfa"] = make_nfa (s).states.size ();
+    state.counters ["dfa"] = states;
+}
+
+BENCHMARK (BM_utf8_dfa)->DenseRange (0, 3)->Unit (benchmark::kMillisecond);
+
+static void
+BM_match_utf8 (benchmark::State& state) {
+    static const char* words [] = {
+        "regular", "expression", "déjà", "vu", "Ελληνικά", "русский",
+        "日本語", "中文", "עברית", "한국어", "naïve", "façade"
+    };
+
+    const auto r = string ("(") + unicode_classes [3] + ")*";
+    const table_t table (minimize_dfa (make_dfa (make_nfa (postfix (r)))));
+
+    mt19937 gen (10);
+
+    vector< string > lines (4096);
+
+    for (auto& s : lines) {
+        for (size_t n = gen () % 16; n; --n)
+            s.append (words [gen () % 12]).append (gen () % 4 ? " " : ", ");
+    }
+
+    size_t bytes = 0, matches = 0;
+
+    for (const auto& s : lines)
+        bytes += s.size ();
+
+    while (state.KeepRunning ()) {
+        for (const auto& s : lines)
+            matches += match (table, s.data (), s.data () + s.size ());
+
+        benchmark::DoNotOptimize (matches);
+    }
+
+    state.SetBytesProcessed (state.iterations () * bytes);
+
+    state.counters ["states"] = table.dead;
+    state.counters ["matches"] = double (matches) / state.iterations ();
+}
+
+BENCHMARK (BM_match_utf8);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,147 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE regex
+
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/regex.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static vector< string >
+make_inputs (size_t n, size_t seed) {
+    mt19937 gen (seed);
+
+    vector< string > v (n);
+
+    for (auto& s : v)
+        for (size_t k = gen () % 24; k; --k)
+            s += "abc" [gen () % 3];
+
+    return v;
+}
+
+BOOST_AUTO_TEST_SUITE(shared_regex)
+
+//
+// The table, the simulated NFA past the bounds and the TDFA agree with the
+// automata they come from:
+//
+BOOST_AUTO_TEST_CASE (regex_engines) {
+    regex_options_t bounded;
+    bounded.dfa.max_states = 2;
+
+    regex_options_t captures;
+    captures.captures = true;
+
+    //
+    // Searching is not for compiled expressions, which match whole inputs:
+    //
+    regex_options_t search;
+    search.dfa.unanchored = search.dfa.earliest = true;
+
+    match_scratch_t scratch;
+
+    for (const string r : { "(a|b)*c", "a(b|c)*a", "^ab|c$", "((a|b)(c))*" }) {
+        const auto dfa = minimize_dfa (make_dfa (make_nfa (postfix (r))));
+
+        const auto x = compile_regex (r);
+        const auto y = compile_regex (r, bounded);
+        const auto z = compile_regex (r, captures);
+        const auto w = compile_regex (r, search);
+
+        BOOST_TEST (bool (x->table));
+        BOOST_TEST (!y->table);
+        BOOST_TEST (!x->tdfa);
+
+        for (const auto& s : make_inputs (200, 14)) {
+            const auto first = s.data (), last = first + s.size ();
+            const auto expected = match (dfa, first, last);
+
+            captures_t groups;
+
+            BOOST_TEST (expected == match (*x, first, last, scratch), r);
+            BOOST_TEST (expected == match (*y, first, last, scratch), r);
+            BOOST_TEST (expected == match (*w, first, last, scratch), r);
+            BOOST_TEST (
+                expected == match (*z, first, last, groups, scratch), r);
+
+            if (expected)
+                BOOST_TEST ((groups [0] == make_pair (
+                                 ptrdiff_t (0), ptrdiff_t (s.size ()))));
+        }
+    }
+
+    captures_t groups;
+    BOOST_CHECK_THROW (
+        match (*compile_regex ("a"), 0, 0, groups, scratch), logic_error);
+}
+
+BOOST_AUTO_TEST_CASE (regex_pool) {
+    scratch_pool_t pool;
+
+    {
+        auto a = pool.acquire ();
+        auto b = pool.acquire ();
+
+        BOOST_TEST (&*a != &*b);
+    }
+
+    const auto a = pool.acquire ();
+    const auto b = pool.acquire ();
+
+    BOOST_TEST (2U == pool.size ());
+}
+
+//
+// One handle and one pool for all threads, each holding a lease for all its
+// matches, of the NFA simulation, which writes to its scratch:
+//
+BOOST_AUTO_TEST_CASE (regex_threads) {
+    regex_options_t options;
+    options.dfa.max_states = 0;
+
+    const auto regex = compile_regex ("(a|b)*a(a|b)(a|b)c*", options);
+    const auto dfa = minimize_dfa (make_dfa (regex->nfa));
+
+    BOOST_TEST (!regex->table);
+
+    const auto inputs = make_inputs (2000, 15);
+
+    scratch_pool_t pool;
+    atomic< size_t > errors { 0 };
+
+    vector< thread > threads;
+
+    for (size_t i = 0; i < 8; ++i)
+        threads.emplace_back ([&, handle = regex]() {
+                auto scratch = pool.acquire ();
+
+                for (const auto& s : inputs) {
+                    const auto first = s.data (), last = first + s.size ();
+
+                    if (match (*handle, first, last, *scratch) !=
+                        match (dfa, first, last))
+                        ++errors;
+                }
+            });
+
+    for (auto& t : threads)
+        t.join ();
+
+    BOOST_TEST (0U == errors);
+    BOOST_TEST (pool.size () <= 8U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
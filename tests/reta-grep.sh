@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# Malformed patterns are reported by reta-grep, with exit status 2, as the
+# errors of its options are, instead of aborting it:
+#
+RETA_GREP=${RETA_GREP:-../examples/reta-grep}
+
+failed=0
+
+for p in 'a[' 'ab)' '*a' 'a||b' '()' 'a{2}' '[z-a]' '\p{Foo}'; do
+    msg=$("$RETA_GREP" "$p" </dev/null 2>&1 >/dev/null)
+    status=$?
+
+    if [ 2 -ne $status ] || [ -z "$msg" ]; then
+        echo "reta-grep '$p': exit status $status, message '$msg'"
+        failed=1
+    fi
+done
+
+if [ abc != "$(echo abc | "$RETA_GREP" 'b|c')" ]; then
+    echo "reta-grep 'b|c': no match"
+    failed=1
+fi
+
+exit $failed
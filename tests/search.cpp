@@ -0,0 +1,200 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE search
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/table.hpp>
+
+#include "generators.hpp"
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static bool
+match (const string& r, const string& s, construction_t c) {
+    const auto first = s.data (), last = first + s.size ();
+
+    const auto nfa = make_nfa (postfix (r), c);
+    const auto dfa = make_dfa (nfa);
+
+    const auto result = match (nfa, first, last);
+    BOOST_TEST (match (dfa, first, last) == result, r << " on " << s);
+
+    return result;
+}
+
+static bool
+match (const string& r, const string& s) {
+    const auto result = match (r, s, construction_t::thompson);
+    BOOST_TEST (match (r, s, construction_t::glushkov) == result);
+
+    return result;
+}
+
+static dfa_t
+make_dfa (const string& r, bool unanchored = false, bool earliest = false) {
+    dfa_options_t options;
+
+    options.unanchored = unanchored;
+    options.earliest = earliest;
+
+    dfa_t dfa;
+
+    const auto status = make_dfa (make_nfa (postfix (r)), options, dfa);
+    BOOST_TEST ((dfa_status_t::ok == status));
+
+    return dfa;
+}
+
+static bool
+search (const search_table_t& table, const string& s) {
+    return search (table, s.data (), s.data () + s.size ());
+}
+
+BOOST_AUTO_TEST_SUITE(search_dfa)
+
+BOOST_AUTO_TEST_CASE (search_anchors) {
+    BOOST_TEST (match ("^ab$", "ab"));
+    BOOST_TEST (match ("^^a$$", "a"));
+    BOOST_TEST (match ("^", ""));
+    BOOST_TEST (match ("$^", ""));
+
+    BOOST_TEST (!match ("a^b", "ab"));
+    BOOST_TEST (!match ("a$b", "ab"));
+
+    //
+    // Anchors inside closures and alternations hold at the ends only:
+    //
+    BOOST_TEST (match ("(^a|b)*", "abb"));
+    BOOST_TEST (!match ("(^a|b)*", "ba"));
+
+    BOOST_TEST (match ("(a|b$)*", "aab"));
+    BOOST_TEST (!match ("(a|b$)*", "aba"));
+
+    BOOST_TEST (match ("(a$|a)b*", "a"));
+    BOOST_TEST (match ("(a$|a)b*", "abb"));
+}
+
+BOOST_AUTO_TEST_CASE (search_basics) {
+    const search_table_t t1 (minimize_dfa (make_dfa ("ab*c", true, true)));
+
+    BOOST_TEST (t1.sink != search_table_t::npos);
+
+    BOOST_TEST (search (t1, "xxabbbcxx"));
+    BOOST_TEST (search (t1, "ac"));
+    BOOST_TEST (!search (t1, "abbb"));
+    BOOST_TEST (!search (t1, ""));
+
+    //
+    // Anchored at the start, the search gives up at the first mismatch:
+    //
+    const search_table_t t2 (minimize_dfa (make_dfa ("^ab", true, true)));
+
+    BOOST_TEST (search (t2, "abxx"));
+    BOOST_TEST (!search (t2, "xab"));
+
+    const search_table_t t3 (minimize_dfa (make_dfa ("ab$", true, true)));
+
+    BOOST_TEST (search (t3, "xxab"));
+    BOOST_TEST (!search (t3, "abx"));
+
+    //
+    // The empty expression is found before the first byte:
+    //
+    const search_table_t t4 (minimize_dfa (make_dfa ("a*", true, true)));
+
+    BOOST_TEST (t4.table.start == t4.sink);
+    BOOST_TEST (search (t4, "xyz"));
+}
+
+//
+// ^ only holds in the initial state: later subsets of the same NFA states do
+// not accept through it:
+//
+BOOST_AUTO_TEST_CASE (search_initial_anchor) {
+    BOOST_TEST (match ("$^", ""));
+    BOOST_TEST (match ("a*$^", ""));
+    BOOST_TEST (!match ("a*$^", "a"));
+    BOOST_TEST (match ("(a|$^)*", "aa"));
+
+    for (const string r : { "$^", "(a|$^)", "a*$^", "(a|$^)*", "(^|a)*b" }) {
+        const auto suffix = make_dfa ("(a|b)*(" + r + ")");
+        const auto infix = make_dfa ("(a|b)*(" + r + ")(a|b)*");
+
+        const auto unanchored = make_dfa (r, true, false);
+
+        const search_table_t table (make_dfa (r, true, true));
+        const search_table_t minimal (minimize_dfa (make_dfa (r, true, true)));
+
+        for (const string x : { "", "a", "b", "ab", "ba", "aab", "bab" }) {
+            const auto first = x.data (), last = first + x.size ();
+
+            BOOST_TEST (
+                match (unanchored, first, last) == match (suffix, first, last),
+                r << " on " << x);
+
+            const auto expected = match (infix, first, last);
+
+            BOOST_TEST (search (table, x) == expected, r << " on " << x);
+            BOOST_TEST (search (minimal, x) == expected, r << " on " << x);
+        }
+    }
+}
+
+//
+// Unanchored, earliest, and both, against the anchored automata of the
+// expression padded with closures over the alphabet:
+//
+BOOST_AUTO_TEST_CASE (search_language) {
+    mt19937 gen (3);
+
+    for (size_t i = 0; i < 300; ++i) {
+        const auto r = make_regex (gen, 4, "abab^$");
+
+        const auto suffix = make_dfa ("(a|b)*(" + r + ")");
+        const auto prefix = make_dfa ("(" + r + ")(a|b)*");
+        const auto infix = make_dfa ("(a|b)*(" + r + ")(a|b)*");
+
+        const auto unanchored = make_dfa (r, true, false);
+        const auto earliest = make_dfa (r, false, true);
+
+        const auto dfa = make_dfa (r, true, true);
+
+        const search_table_t table (dfa);
+        const search_table_t minimal (minimize_dfa (dfa));
+
+        for (size_t j = 0; j < 30; ++j) {
+            string s (gen () % 10, 0);
+
+            for (auto& x : s)
+                x = "ab" [gen () % 2];
+
+            const auto first = s.data (), last = first + s.size ();
+
+            BOOST_TEST (
+                match (unanchored, first, last) == match (suffix, first, last),
+                r << " on " << s);
+
+            BOOST_TEST (
+                match (earliest, first, last) == match (prefix, first, last),
+                r << " on " << s);
+
+            const auto expected = match (infix, first, last);
+
+            BOOST_TEST (match (dfa, first, last) == expected, r << " on " << s);
+
+            BOOST_TEST (search (table, s) == expected, r << " on " << s);
+            BOOST_TEST (search (minimal, s) == expected, r << " on " << s);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,92 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE stats
+
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/stats.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(stats)
+
+BOOST_AUTO_TEST_CASE (stats_pipeline) {
+    stats_t stats;
+
+    {
+        stats_scope_t scope (stats);
+
+        const auto nfa = make_nfa (postfix ("(a|b)*a(a|b)(a|b)"));
+        const auto dfa = make_dfa (nfa);
+        const auto min = minimize_dfa_table (dfa);
+
+#if defined (RETA_STATS)
+        BOOST_TEST (stats.postfix.calls  == 1U);
+        BOOST_TEST (stats.make_nfa.calls == 1U);
+        BOOST_TEST (stats.make_dfa.calls == 1U);
+        BOOST_TEST (stats.minimize.calls == 1U);
+
+        BOOST_TEST (stats.nfa_states == nfa.states.size ());
+        BOOST_TEST (stats.dfa_states == dfa.states.size ());
+
+        BOOST_TEST (dfa.states.size () == accumulate (
+                        stats.closure_sizes.begin (),
+                        stats.closure_sizes.end (), size_t ()));
+
+        BOOST_TEST (stats.intern_misses + 1 == dfa.states.size ());
+        BOOST_TEST (stats.intern_hits > 0U);
+
+        BOOST_TEST (stats.minimization_sweeps > 0U);
+        BOOST_TEST (stats.peak_bytes > 0U);
+#else
+        BOOST_TEST (stats.make_dfa.calls == 0U);
+        BOOST_TEST (stats.dfa_states == 0U);
+#endif // RETA_STATS
+    }
+
+    const auto calls = stats.make_nfa.calls;
+    make_nfa (postfix ("ab"));
+
+    BOOST_TEST (stats.make_nfa.calls == calls);
+
+    stringstream ss;
+    ss << stats;
+
+    BOOST_TEST (!ss.str ().empty ());
+}
+
+BOOST_AUTO_TEST_CASE (stats_trim) {
+    stats_t stats;
+
+    {
+        stats_scope_t scope (stats);
+
+        //
+        // One state unreachable, one from which nothing is accepted:
+        //
+        dfa_t dfa { };
+
+        stringstream ss ("0 4 4 0 97 1 0 98 2 2 97 2 3 97 1 1 1 ");
+        ss >> dfa;
+
+        BOOST_TEST (trim (dfa).states.size () == 2U);
+    }
+
+#if defined (RETA_STATS)
+    BOOST_TEST (stats.trimmed_unreachable == 1U);
+    BOOST_TEST (stats.trimmed_dead == 1U);
+#else
+    BOOST_TEST (stats.trimmed_unreachable == 0U);
+#endif // RETA_STATS
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,204 @@
+// -*- mode: c++; -*-
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utf8
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <reta/nfa.hpp>
+#include <reta/dfa.hpp>
+#include <reta/tdfa.hpp>
+#include <reta/utf8.hpp>
+
+#include <boost/test/unit_test.hpp>
+namespace utf = boost::unit_test;
+
+static bool
+covers (const vector< utf8_sequence_t >& seqs, const string& s) {
+    for (const auto& seq : seqs) {
+        if (seq.size () != s.size ())
+            continue;
+
+        size_t i = 0;
+
+        for (; i < s.size (); ++i) {
+            const auto b = uint8_t (s [i]);
+
+            if (b < seq [i].first || seq [i].second < b)
+                break;
+        }
+
+        if (i == s.size ())
+            return true;
+    }
+
+    return false;
+}
+
+static bool
+match (const string& r, const string& s) {
+    const auto first = s.data (), last = first + s.size ();
+
+    const auto nfa = make_nfa (postfix (r));
+    const auto result = match (nfa, first, last);
+
+    BOOST_TEST (match (minimize_dfa (make_dfa (nfa)), first, last) == result,
+                r << " on " << s);
+
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(unicode)
+
+BOOST_AUTO_TEST_CASE (utf8_encoding) {
+    for (const uint32_t c : { 0x0, 0x7f, 0x80, 0x7ff, 0x800, 0xffff, 0x10000,
+                0x10ffff }) {
+        const auto s = encode_utf8 (c);
+
+        const char* first = s.data ();
+        uint32_t x = 0;
+
+        BOOST_TEST (decode_utf8 (first, s.data () + s.size (), x));
+        BOOST_TEST (x == c);
+        BOOST_TEST (first == s.data () + s.size ());
+    }
+
+    //
+    // Overlong, surrogate, truncated and stray continuation bytes:
+    //
+    for (const string s : { "\xc0\x80", "\xed\xa0\x80", "\xe2\x82", "\x80" }) {
+        const char* first = s.data ();
+        uint32_t x = 0;
+
+        BOOST_TEST (!decode_utf8 (first, s.data () + s.size (), x));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (utf8_sequences_all) {
+    const auto seqs = utf8_sequences (0, max_code_point);
+
+    BOOST_TEST (seqs.size () == 9U);
+
+    BOOST_TEST (
+        (seqs [0] == utf8_sequence_t { { 0x00, 0x7f } }));
+    BOOST_TEST (
+        (seqs [4] == utf8_sequence_t {
+            { 0xed, 0xed }, { 0x80, 0x9f }, { 0x80, 0xbf } }));
+    BOOST_TEST (
+        (seqs [8] == utf8_sequence_t {
+            { 0xf4, 0xf4 }, { 0x80, 0x8f }, { 0x80, 0xbf }, { 0x80, 0xbf } }));
+}
+
+//
+// The sequences of random ranges cover the encodings of the code points in the
+// range, and only those:
+//
+BOOST_AUTO_TEST_CASE (utf8_sequences_random) {
+    mt19937 gen (9);
+
+    uniform_int_distribution< uint32_t > any (0, max_code_point);
+
+    for (size_t i = 0; i < 200; ++i) {
+        const uint32_t lo = any (gen);
+        const uint32_t hi = (min) (
+            max_code_point, uint32_t (lo + gen () % (i % 2 ? 0x100 : 0x40000)));
+
+        const auto seqs = utf8_sequences (lo, hi);
+
+        BOOST_TEST (seqs.size () <= 24U);
+
+        for (size_t j = 0; j < 100; ++j) {
+            const uint32_t c = j % 2 ? any (gen) : lo + gen () % (hi - lo + 1);
+
+            if (0xd800 <= c && c <= 0xdfff)
+                continue;
+
+            BOOST_TEST (
+                covers (seqs, encode_utf8 (c)) == (lo <= c && c <= hi),
+                lo << " " << hi << " " << c);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (utf8_classes) {
+    BOOST_TEST (match ("caf[eé]", "café"));
+    BOOST_TEST (match ("caf[eé]", "cafe"));
+    BOOST_TEST (!match ("caf[eé]", "cafè"));
+
+    BOOST_TEST (match ("[a-zà-ÿ]*", "façade"));
+    BOOST_TEST (match ("日本", "日本"));
+
+    BOOST_TEST (match ("\\p{L}\\p{L}*", "日本語"));
+    BOOST_TEST (match ("\\p{L}\\p{L}*", "Ωmega"));
+    BOOST_TEST (!match ("\\p{L}\\p{L}*", "a1"));
+
+    BOOST_TEST (match ("\\p{Nd}*", "123٣"));
+    BOOST_TEST (match ("\\p{Lu}\\p{Ll}*", "Élan"));
+    BOOST_TEST (!match ("\\p{Lu}\\p{Ll}*", "élan"));
+
+    BOOST_TEST (match ("[^a]", "é"));
+    BOOST_TEST (match ("[^a]", "\xf0\x9f\x98\x80"));
+    BOOST_TEST (!match ("[^a]", "a"));
+    BOOST_TEST (!match ("[^a]", "\xff"));
+
+    BOOST_TEST (match ("\\P{L}", "1"));
+    BOOST_TEST (!match ("\\P{L}", "ж"));
+
+    BOOST_TEST (match ("[\\p{L}\\p{Nd}]*", "ab12жж"));
+    BOOST_TEST (match ("\\x{e9}", "é"));
+    BOOST_TEST (match ("\\(a\\)", "(a)"));
+    BOOST_TEST (match ("[\\]-]*", "]-]"));
+}
+
+//
+// Malformed classes, escapes and UTF-8, and braces outside of an escape:
+//
+BOOST_AUTO_TEST_CASE (utf8_errors) {
+    for (const string r : {
+            "[z-a]", "[a-\\p{L}]", "[ab", "\\p{Foo}", "\\p{L", "\\pL",
+            "\\x{110000}", "\\x{}", "\\x{zz}", "a\\", "caf\xe9",
+            "\xc0\x80", "{61-61}", "a{2}" }) {
+        BOOST_CHECK_THROW (postfix (r), invalid_argument);
+        BOOST_CHECK_THROW (postfix_captures (r), invalid_argument);
+    }
+
+    BOOST_TEST (match ("a\\{b\\}", "a{b}"));
+}
+
+//
+// A class of a hundred thousand code points takes a few thousand states in the
+// NFA, and not that many in the DFA:
+//
+BOOST_AUTO_TEST_CASE (utf8_size) {
+    const auto nfa = make_nfa (postfix ("\\p{L}"));
+    const auto dfa = minimize_dfa (make_dfa (nfa));
+
+    BOOST_TEST (nfa.states.size () < 2000U);
+    BOOST_TEST (dfa.states.size () < 500U);
+
+    const auto any = make_nfa (postfix ("[^a]"));
+    BOOST_TEST (any.states.size () < 20U);
+}
+
+BOOST_AUTO_TEST_CASE (utf8_captures) {
+    size_t groups = 0;
+
+    const auto nfa = make_nfa (
+        postfix_captures ("(\\p{Lu})(\\p{Ll}*)\\(", &groups));
+
+    const auto tdfa = make_tdfa (nfa, 2 * groups);
+
+    const string s = "Élan(";
+
+    captures_t captures;
+
+    BOOST_TEST (match (tdfa, s.data (), s.data () + s.size (), captures));
+    BOOST_TEST ((captures == captures_t { { 0, 6 }, { 0, 2 }, { 2, 5 } }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()